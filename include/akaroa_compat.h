@@ -0,0 +1,41 @@
+/*
+ * include/akaroa_compat.h
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef AKAROA_COMPAT_H
+#define AKAROA_COMPAT_H
+
+/*
+ * The Akaroa calls the simulators use. Built with HAVE_AKAROA (configure
+ * --with-akaroa) they are Akaroa's own, to run under akrun. Otherwise they
+ * are served in-process by the statistics engine: parameters are read from
+ * the Akaroa parameter file named by HYDRA_AK_PARAMS, if set, and the
+ * estimates are printed once the simulation is over.
+ */
+#ifdef HAVE_AKAROA
+#include <akaroa.H>
+#include <akaroa/distributions.H>
+#else
+#include <statistics.h>
+
+void AkDeclareParameters(int nparams);
+/* param counts from 1 */
+void AkParamObservation(int param, double value);
+int AkSimulationOver(void);
+
+double AkRandomReal(void);
+double Uniform(double min, double max);
+long UniformInt(long min, long max);
+double Normal(double mean, double sd);
+
+/* the engine behind the calls above */
+SequentialEstimator &akEstimator(void);
+#endif
+
+#endif
@@ -13,9 +13,8 @@
 
 #include <list>
 #include <vector>
-#include <ilcplex/ilocplex.h>
-ILOSTLBEGIN
 
+#include <numarray.h>
 #include <runinfo.h>
 #include <task.h>
 
@@ -35,34 +34,59 @@ private:
 
 	/* This has to be shadowed */
 	vector <class Task> _tasks;
-	IloNumArray2 _frequencies;
-	IloNumArray2 _voltages;
-	IloNumArray2 _pdyn;
-	IloNumArray2 _pidle;
-
-	IloNumArray4 _assignment;
-
-	IloNumArray _resourcePriorities;
+	NumArray2 _frequencies;
+	NumArray2 _voltages;
+	NumArray2 _pdyn;
+	NumArray2 _pidle;
 
 	vector <class Task> &tasks;
-	IloNumArray2 &frequencies;
-	IloNumArray2 &voltages;
-	IloNumArray2 &pdyn;
-	IloNumArray2 &pidle;
-
-	IloNumArray4 &assignment;
+	NumArray2 &frequencies;
+	NumArray2 &voltages;
+	NumArray2 &pdyn;
+	NumArray2 &pidle;
 
-	IloNumArray &resourcePriorities;
+	NumArray resourcePriorities;
 
 	runInfo runConfig;
 	const char *fileModel;
 
-
+	/*
+	 * Placement index, built once from the assignment: cluster, processor
+	 * and level of each task (-1 when unassigned) and, per processor slot
+	 * (s * nProcessors + i), its hp-set: the assigned tasks sorted by
+	 * decreasing priority, nTasks entries each. All the analysis walks
+	 * these instead of the (cluster x proc x task x freq) assignment.
+	 */
+	vector <int> taskCluster;
+	vector <int> taskProcessor;
+	vector <int> taskLevel;
+	vector <int> procTasks;
+	vector <int> procCount;
+
+	/* Incremental response time analysis */
+	enum { RTA_CLEAN, RTA_WARM, RTA_COLD };
+	bool incremental;
+	vector <char> taskState;
+	vector <int> dirtyTasks;
+
+	void indexAssignment(const NumArray4 &assignment);
+	int processorSlot(int task)
+	{
+		return taskCluster[task] * nProcessors + taskProcessor[task];
+	}
+	void insertProcessorTask(int proc, int task);
+	void removeProcessorTask(int proc, int task);
+	void markTask(int task, char state);
+	void markAllTasks(char state);
+	void markLowerPriority(int proc, int task, char state);
+	void markCluster(int cluster, char state);
 	void distributeTaskFrequencies();
 	void computeResourcePriorities();
 	void computeExclusionInfluency();
 	void computePrecedenceInfluency();
+	void computeTaskPrecedenceInfluency(int j, double Ip);
 	void computeArchitectureInfluence();
+	void processorUtilization(int s, int i, double &ui, double &si, int &n);
 	double computeTaskArchitectureInfluence(int s, int i, int j);
 	unsigned long long gcd(unsigned long long a, unsigned long long b);
 	unsigned long long gcd_hash(unsigned long long i, unsigned long long j);
@@ -72,27 +96,15 @@ private:
 	long long computeLCM(void);
 public:
 	/* Constructors */
-	SchedulabilityAnalysis(IloEnv &env, runInfo runtime);
-	SchedulabilityAnalysis(IloEnv &env, runInfo runtime, const char *filename, bool useAssignment);
-	SchedulabilityAnalysis(IloEnv &env, runInfo runtime, int ntask,
-		int nresources, double lp, IloNumArray2 &freqs, IloNumArray2 &volts,
-		vector <class Task> &tset, IloNumArray4 &assig);
-
-	SchedulabilityAnalysis(IloEnv &env, runInfo runtime, int ntask,
-		int nresources, double lp, IloNumArray2 &freqs, IloNumArray2 &power_dyn,
-		IloNumArray2 &power_idle, vector <class Task> &tset, IloNumArray4 &assig);
-	~SchedulabilityAnalysis()
-	{
-		_tasks.clear();
-		_frequencies.end();
-		_voltages.end();
-		_pdyn.end();
-		_pidle.end();
-
-		_assignment.end();
-
-		_resourcePriorities.end();
-	}
+	SchedulabilityAnalysis(runInfo runtime);
+	SchedulabilityAnalysis(runInfo runtime, const char *filename, bool useAssignment);
+	SchedulabilityAnalysis(runInfo runtime, int ntask,
+		int nresources, double lp, NumArray2 &freqs, NumArray2 &volts,
+		vector <class Task> &tset, const NumArray4 &assig);
+
+	SchedulabilityAnalysis(runInfo runtime, int ntask,
+		int nresources, double lp, NumArray2 &freqs, NumArray2 &power_dyn,
+		NumArray2 &power_idle, vector <class Task> &tset, const NumArray4 &assig);
 	/* Schedulability Analysis */
 	void computeAnalysis();
 	bool evaluateResponse(double &spread);
@@ -100,8 +112,13 @@ public:
 	void computeTotalUtilization(double &u);
 	double computeSystemEnergy(void);
 
+	/* Incremental analysis */
+	void setIncremental(bool incremental);
+	void moveTask(int task, int cluster, int processor, int level);
+	void unassignTask(int task);
+
 	/* IO */
-	void readModel(IloEnv &env);
+	void readModel(void);
 	void printTaskModel();
 	void printTaskInfluencies();
 	void printTaskAnalysis();
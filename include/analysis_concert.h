@@ -0,0 +1,80 @@
+/*
+ * include/analysis_concert.h
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef ANALYSIS_CONCERT_H
+#define ANALYSIS_CONCERT_H
+
+#include <ilcplex/ilocplex.h>
+ILOSTLBEGIN
+
+#include <numarray.h>
+#include <analysis.h>
+
+/*
+ * Thin adapter between Concert arrays and the CPLEX-free analysis core.
+ * Only the solvers include this; they convert their model data once and
+ * hand plain NumArrays to SchedulabilityAnalysis.
+ */
+static inline void fromConcert(const IloNum &from, double &to)
+{
+	to = from;
+}
+
+static inline void fromConcert(const IloNumArray &from, NumArray &to)
+{
+	IloInt i;
+
+	to.resize(from.getSize());
+	for (i = 0; i < from.getSize(); i++)
+		to[i] = from[i];
+}
+
+template <class C, class T>
+void fromConcert(const IloArray <C> &from, vector <T> &to)
+{
+	IloInt i;
+
+	to.resize(from.getSize());
+	for (i = 0; i < from.getSize(); i++)
+		fromConcert(from[i], to[i]);
+}
+
+/*
+ * Solvers that keep their IloEnv across models end what each model
+ * allocated, nested arrays and the variables they hold included.
+ */
+static inline void endConcert(IloNumArray &a)
+{
+	a.end();
+}
+
+static inline void endConcert(IloNumVarArray &a)
+{
+	a.endElements();
+	a.end();
+}
+
+static inline void endConcert(IloConstraintArray &a)
+{
+	a.endElements();
+	a.end();
+}
+
+template <class C>
+void endConcert(IloArray <C> &a)
+{
+	IloInt i;
+
+	for (i = 0; i < a.getSize(); i++)
+		endConcert(a[i]);
+	a.end();
+}
+
+#endif
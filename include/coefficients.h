@@ -0,0 +1,52 @@
+/*
+ * include/coefficients.h
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef COEFFICIENTS_H
+#define COEFFICIENTS_H
+
+#include <iostream>
+
+#include <numarray.h>
+#include <solver.h>
+
+/* Power of an idle agent, in the energy of every solver */
+#define MGAP_PIDLE	0.260
+
+/*
+ * Cost tensors of an MGAP model, computed once per model: for every
+ * (agent, task, level), the computation time C, the utilization U and the
+ * energy over the hyperperiod. Each tensor is one flat array, agent major
+ * and level minor, at index(agent, task, level). They are not stored with
+ * the model: every reader computes them on load, in O(agents x tasks x
+ * levels), with the idle power it prices energy at.
+ */
+struct mgapCoefficients {
+	int nAgents, nTasks, nLevels;
+	double LCM;		/* hyperperiod */
+	NumArray C;
+	NumArray U;
+	NumArray energy;
+
+	mgapCoefficients(void)
+		:nAgents(0), nTasks(0), nLevels(0), LCM(0.0)
+	{
+	}
+	int index(int agent, int task, int level) const
+	{
+		return (agent * nTasks + task) * nLevels + level;
+	}
+	/* energy counts an idle agent at Pidle */
+	void compute(const mgapModel &model, double Pidle = MGAP_PIDLE);
+};
+
+/* Text dump, in the array syntax of the model files */
+ostream &writeCoefficients(ostream &os, const mgapCoefficients &coef);
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ * include/corpus.h
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include <solver.h>
+
+/*
+ * Packed, binary set of MGAP models, mapped read-only by its readers.
+ * Layout, native byte order, every field 8 byte aligned:
+ *
+ *   corpusHeader
+ *   model records, each a corpusRecordHeader followed by the arrays
+ *     priority[ntasks] period[ntasks] deadline[ntasks]
+ *     cycles[nagents][ntasks] voltage[nagents][nlevels]
+ *     frequency[nagents][nlevels]
+ *   index, one uint64_t file offset per record
+ */
+#define CORPUS_MAGIC	"HYDRACRP"
+#define CORPUS_VERSION	1
+
+struct corpusHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t nmodels;
+	uint64_t index;		/* file offset of the record offsets */
+};
+
+struct corpusRecordHeader {
+	uint32_t ntasks;
+	uint32_t nagents;
+	uint32_t nlevels;
+	uint32_t reserved;
+	double alpha;
+};
+
+/* One model as laid out in the mapping, nothing is copied */
+struct corpusRecord {
+	int ntasks, nagents, nlevels;
+	double alpha;
+	const double *priority;		/* tasks */
+	const double *period;		/* tasks */
+	const double *deadline;		/* tasks */
+	const double *cycles;		/* agents x tasks */
+	const double *voltage;		/* agents x levels */
+	const double *frequency;	/* agents x levels */
+};
+
+class Corpus {
+private:
+	int fd;
+	const char *base;
+	size_t length;
+	const struct corpusHeader *header;
+	const uint64_t *offsets;
+
+	Corpus(const Corpus &);
+	Corpus &operator=(const Corpus &);
+public:
+	Corpus(void);
+	~Corpus();
+
+	/* false when filename is not a readable, consistent corpus */
+	bool open(const char *filename);
+	void close(void);
+	int size(void)
+	{
+		return header ? header->nmodels : 0;
+	}
+	bool record(int i, struct corpusRecord &r);
+	bool get(int i, mgapModel &model);
+
+	/* tells a corpus from a text model by its magic */
+	static bool isCorpus(const char *filename);
+};
+
+/* Appends models to a new corpus, the index is written by close() */
+class CorpusWriter {
+private:
+	FILE *file;
+	uint64_t position;
+	vector <uint64_t> offsets;
+
+	bool write(const void *data, size_t size);
+	bool write(const NumArray &array);
+
+	CorpusWriter(const CorpusWriter &);
+	CorpusWriter &operator=(const CorpusWriter &);
+public:
+	CorpusWriter(void);
+	~CorpusWriter();
+
+	bool open(const char *filename);
+	/* false when the model arrays are ragged or writing failed */
+	bool add(const mgapModel &model);
+	bool close(void);
+};
+
+#endif
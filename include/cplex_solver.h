@@ -0,0 +1,269 @@
+/*
+ * include/cplex_solver.h
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef CPLEX_SOLVER_H
+#define CPLEX_SOLVER_H
+
+#include <sys/time.h>
+
+#include <ilcplex/ilocplex.h>
+ILOSTLBEGIN
+
+#include <evaluator.h>
+#include <solver.h>
+#include <heuristic.h>
+
+/* What the CPLEX solvers share, beyond the model data adapters */
+
+/* relative, the heuristic and CPLEX sum the energy in different orders */
+#define CUTOFF_TOLERANCE	1e-6
+
+#define ROUNDING_INTERVAL	10	/* nodes between rounded relaxations */
+
+/* microseconds from s to e */
+long get_execution_time(struct timeval s, struct timeval e);
+/* prints the analysis of the (agent x task x level) solution x of mgap */
+void dumpConfigurationInfo(mgapModel &mgap, const NumArray3 &x);
+
+/*
+ * Generic callback of the MIP solvers. It checks the integer candidates
+ * on the analysis, and rounds the relaxation of every ROUNDING_INTERVAL
+ * nodes into a solution valid under the test of the model, posted when
+ * it improves on the incumbent. CPLEX calls it from all its threads at
+ * once, so each thread gets its own evaluator and rounding, indexed by
+ * the thread id, and nothing else is written. Subclasses look at the
+ * evaluated candidate and reject it with the constraints that cut it off.
+ */
+class SolverCallback : public IloCplex::Callback::Function {
+private:
+	struct threadState {
+		FeasibilityEvaluator *evaluator;	/* NULL without checks */
+		RelaxationRounding *rounding;		/* NULL without rounding */
+		NumArray relaxation, solution;
+	};
+	vector <struct threadState> states;	/* one per thread */
+
+	SolverCallback(const SolverCallback &);
+	SolverCallback &operator=(const SolverCallback &);
+
+	void checkCandidate(const IloCplex::Callback::Context &context,
+				struct threadState &state)
+	{
+		IloInt i, j, k;
+
+		/* an unbounded ray, not a solution: the model is bounded */
+		if (!context.isCandidatePoint())
+			return;
+
+		for (i = 0; i < vars.getSize(); i++)
+			for (j = 0; j < vars[i].getSize(); j++)
+				for (k = 0; k < vars[i][j].getSize(); k++)
+					state.evaluator->value(i, j, k) =
+						context.getCandidatePoint(vars[i][j][k]);
+
+		check(context, *state.evaluator);
+	}
+	void roundRelaxation(const IloCplex::Callback::Context &context,
+				struct threadState &state)
+	{
+		IloNum incumbent = context.getDoubleInfo(
+				IloCplex::Callback::Context::Info::BestSolution);
+		double energy;
+		IloInt i, j, k, c;
+
+		/* a node the incumbent prunes has nothing to give */
+		if (context.getIntInfo(IloCplex::Callback::Context::Info::NodeCount) %
+				ROUNDING_INTERVAL != 0 ||
+				context.getRelaxationObjective() >= incumbent)
+			return;
+
+		for (c = i = 0; i < vars.getSize(); i++)
+			for (j = 0; j < vars[i].getSize(); j++)
+				for (k = 0; k < vars[i][j].getSize(); k++)
+					state.relaxation[c++] =
+						context.getRelaxationPoint(vars[i][j][k]);
+
+		if (!state.rounding->round(state.relaxation, state.solution, energy) ||
+				energy >= incumbent * (1.0 - CUTOFF_TOLERANCE))
+			return;
+
+		IloNumVarArray postVars(context.getEnv());
+		IloNumArray postVals(context.getEnv());
+
+		for (c = i = 0; i < vars.getSize(); i++)
+			for (j = 0; j < vars[i].getSize(); j++)
+				for (k = 0; k < vars[i][j].getSize(); k++) {
+					postVars.add(vars[i][j][k]);
+					postVals.add(state.solution[c++]);
+				}
+		/*
+		 * Rounded every ROUNDING_INTERVAL nodes, then repaired and
+		 * improved: CPLEX fixes the variables to it, checks it against
+		 * the model and takes it as incumbent if feasible and better.
+		 */
+		context.postHeuristicSolution(postVars, postVals, energy,
+			IloCplex::Callback::Context::SolutionStrategy::Solve);
+
+		postVars.end();
+		postVals.end();
+	}
+protected:
+	IloArray<IloArray<IloNumVarArray> > &vars;
+
+	/* evaluator holds the candidate of context, nothing evaluated yet */
+	virtual void check(const IloCplex::Callback::Context &,
+				FeasibilityEvaluator &)
+	{
+	}
+
+	/* rejects the candidate with a no-good on its placement, once evaluated */
+	void rejectPlacement(const IloCplex::Callback::Context &context,
+				FeasibilityEvaluator &evaluator)
+	{
+		IloExpr v(context.getEnv());
+		IloInt j, n = 0;
+
+		for (j = 0; j < vars[0].getSize(); j++)
+			if (evaluator.getAgent(j) >= 0) {
+				v += vars[evaluator.getAgent(j)][j][evaluator.getLevel(j)];
+				n++;
+			}
+		context.rejectCandidate(v <= (IloNum)n - 1.0);
+		v.end();
+	}
+public:
+	SolverCallback(IloArray<IloArray<IloNumVarArray> > &vars, int threads)
+		:states(threads), vars(vars)
+	{
+		int t;
+
+		for (t = 0; t < threads; t++) {
+			states[t].evaluator = NULL;
+			states[t].rounding = NULL;
+		}
+	}
+	virtual ~SolverCallback()
+	{
+		unsigned int t;
+
+		for (t = 0; t < states.size(); t++) {
+			delete states[t].evaluator;
+			delete states[t].rounding;
+		}
+	}
+
+	/* candidates go to check() on a copy of evaluator per thread */
+	void checkCandidates(const FeasibilityEvaluator &evaluator)
+	{
+		unsigned int t;
+
+		for (t = 0; t < states.size(); t++)
+			states[t].evaluator = new FeasibilityEvaluator(evaluator);
+	}
+	/* relaxations are rounded into solutions valid under test */
+	void roundRelaxations(const mgapModel &model, fitnessTest test)
+	{
+		int n = model.cycles.size() * model.period.size() *
+			model.frequency[0].size();
+		unsigned int t;
+
+		for (t = 0; t < states.size(); t++) {
+			states[t].rounding = new RelaxationRounding(model, test);
+			states[t].relaxation.resize(n);
+		}
+	}
+	/* the contexts to use the callback for, 0 for none */
+	CPXLONG contexts(void) const
+	{
+		CPXLONG mask = 0;
+
+		if (!states.empty() && states[0].evaluator)
+			mask |= IloCplex::Callback::Context::Id::Candidate;
+		if (!states.empty() && states[0].rounding)
+			mask |= IloCplex::Callback::Context::Id::Relaxation;
+
+		return mask;
+	}
+
+	void invoke(const IloCplex::Callback::Context &context)
+	{
+		struct threadState &state = states[
+			context.getIntInfo(IloCplex::Callback::Context::Info::ThreadId)];
+
+		if (context.inCandidate())
+			checkCandidate(context, state);
+		else if (context.inRelaxation())
+			roundRelaxation(context, state);
+	}
+};
+
+/*
+ * setParallel: threads and parallel mode of cplex from limits, 0 threads
+ * for one per core and, by default, the single deterministic thread the
+ * solvers always ran on. Returns the threads CPLEX may call back from.
+ */
+static inline int setParallel(IloCplex &cplex, const solverLimits &limits)
+{
+	int threads = limits.threads > 0 ? limits.threads :
+			limits.threads < 0 ? 1 : cplex.getNumCores();
+
+	cplex.setParam(IloCplex::Threads, threads);
+	cplex.setParam(IloCplex::Param::Parallel, limits.opportunistic ?
+				IloCplex::Opportunistic : IloCplex::Deterministic);
+
+	return threads;
+}
+
+/*
+ * warmStart: the start of limits as a MIP start of x or, when it brings
+ * none, the heuristic solution valid under test. The heuristic energy
+ * also becomes the cutoff when test is the one of the model (cutoff) and
+ * limits bring no upper cut. False when there was no start to give.
+ * @complexity: O(agents x tasks x levels) plus the heuristic
+ */
+static inline bool warmStart(IloCplex &cplex,
+				IloArray<IloArray<IloNumVarArray> > &x,
+				const mgapModel &mgap, const solverLimits &limits,
+				fitnessTest test, bool cutoff)
+{
+	const NumArray3 *start = &limits.start;
+	NumArray3 heuristic;
+	double energy;
+	IloInt i, j, k;
+
+	if (start->empty() && limits.warmStart && !limits.relaxIntegrity &&
+			heuristicStart(mgap, test, heuristic, energy)) {
+		start = &heuristic;
+		if (cutoff && limits.upperCut <= 0.0)
+			cplex.setParam(IloCplex::CutUp,
+					energy * (1.0 + CUTOFF_TOLERANCE));
+	}
+	if (start->empty())
+		return false;
+
+	IloNumVarArray startVar(cplex.getEnv());
+	IloNumArray startVal(cplex.getEnv());
+
+	for (i = 0; i < x.getSize(); i++)
+		for (j = 0; j < x[i].getSize(); j++)
+			for (k = 0; k < x[i][j].getSize(); k++) {
+				startVar.add(x[i][j][k]);
+				startVal.add((*start)[i][j][k]);
+			}
+
+	cplex.addMIPStart(startVar, startVal);
+
+	startVar.end();
+	startVal.end();
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * include/evaluator.h
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include <vector>
+
+#include <numarray.h>
+#include <runinfo.h>
+#include <task.h>
+#include <analysis.h>
+
+/*
+ * Feasibility check of (agent x task x level) 0-1 solutions for the solver
+ * callbacks. Everything is allocated at construction: a check only copies
+ * the solution into the value buffer, moves the tasks whose placement
+ * changed since the previous check and reruns the incremental analysis.
+ * Copies rebuild their own analysis, so a callback can hold one per
+ * thread. Callers that track the placement themselves, as the GA does,
+ * move single tasks with place() and check with the *Holds() variants.
+ */
+class FeasibilityEvaluator {
+private:
+	int nAgents;
+	int nTasks;
+	int nLevels;
+
+	NumArray2 cycles;
+	NumArray2 frequencies;
+	NumArray2 voltages;
+	vector <class Task> tasks;
+
+	/* solution values, (agent * nTasks + task) * nLevels + level */
+	NumArray values;
+	/* placement the analysis currently holds, -1 when unassigned */
+	vector <int> taskAgent;
+	vector <int> taskLevel;
+
+	SchedulabilityAnalysis sched;
+
+	void initTasks(const NumArray &priority, const NumArray &period,
+		const NumArray &deadline);
+	void moveTask(int task, int agent, int level);
+	void update();
+
+	FeasibilityEvaluator &operator=(const FeasibilityEvaluator &);
+public:
+	FeasibilityEvaluator(const NumArray &priority, const NumArray &period,
+		const NumArray &deadline, const NumArray2 &cycles,
+		const NumArray2 &frequency, const NumArray2 &voltage);
+	FeasibilityEvaluator(const FeasibilityEvaluator &evaluator);
+
+	double &value(int agent, int task, int level)
+	{
+		return values[(agent * nTasks + task) * nLevels + level];
+	}
+
+	bool evaluateResponse();
+	bool evaluateUtilization(double bound);
+
+	/* task to (agent, level), -1 to unassign it, values kept in step */
+	void place(int task, int agent, int level);
+	/* the analysis of the placement as it stands, without update() */
+	void analyse()
+	{
+		sched.computeAnalysis();
+	}
+	/* after analyse(), whether task meets its deadline */
+	bool meetsDeadline(int task)
+	{
+		return tasks[task].getDeadline() >= tasks[task].getResponse() &&
+			tasks[task].getIp() >= 0;
+	}
+	bool responseHolds();
+	bool utilizationHolds(double bound);
+
+	/* placement of the last evaluation, -1 when unassigned */
+	int getAgent(int task)
+	{
+		return taskAgent[task];
+	}
+	int getLevel(int task)
+	{
+		return taskLevel[task];
+	}
+	bool conflict(int agent, vector <int> &set);
+};
+
+#endif
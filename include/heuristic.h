@@ -0,0 +1,52 @@
+/*
+ * include/heuristic.h
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef HEURISTIC_H
+#define HEURISTIC_H
+
+#include <numarray.h>
+#include <solver.h>
+
+class fitnessCalcPGA;
+class Individual;
+
+/*
+ * heuristicStart: the GA seed heuristics and random candidates, repaired
+ * and improved by its local search, for the MIP solvers to start from. start gets the
+ * cheapest solution valid under test, and energy its energy; false when
+ * neither is valid.
+ */
+bool heuristicStart(const mgapModel &model, fitnessTest test,
+			NumArray3 &start, double &energy);
+
+/*
+ * Rounding of the fractional solutions of the MIP solvers, flat as
+ * (agent * nTasks + task) * nLevels + level like the cost tensors, into
+ * solutions valid under test, through the GA repair and local search.
+ * It keeps a GA calculator of the model, so each thread needs its own.
+ */
+class RelaxationRounding {
+private:
+	fitnessCalcPGA *calc;
+	Individual *ind;
+	int nAgents, nTasks, nLevels;
+
+	RelaxationRounding(const RelaxationRounding &);
+	RelaxationRounding &operator=(const RelaxationRounding &);
+public:
+	RelaxationRounding(const mgapModel &model, fitnessTest test);
+	~RelaxationRounding();
+
+	/* solution gets 0-1 values and energy its energy, false when none */
+	bool round(const NumArray &relaxation, NumArray &solution,
+			double &energy);
+};
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * include/numarray.h
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef NUMARRAY_H
+#define NUMARRAY_H
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Plain numeric arrays used by the analysis core in place of the Concert
+ * IloNumArray family, so that it builds without CPLEX. They are read and
+ * written in the same "[a, b, [c, d]]" text syntax, hence model files and
+ * solution dumps stay interchangeable with the Concert based tools.
+ */
+typedef vector <double> NumArray;
+typedef vector <NumArray> NumArray2;
+typedef vector <NumArray2> NumArray3;
+typedef vector <NumArray3> NumArray4;
+
+static inline istream &readArray(istream &is, double &value)
+{
+	return is >> value;
+}
+
+/* Sets failbit on malformed input, leaving array partially filled */
+template <class T>
+istream &readArray(istream &is, vector <T> &array)
+{
+	char c;
+
+	array.clear();
+	if (!(is >> c) || c != '[') {
+		is.setstate(ios::failbit);
+		return is;
+	}
+
+	if ((is >> ws).peek() == ']') {
+		is.get();
+		return is;
+	}
+
+	do {
+		array.resize(array.size() + 1);
+		if (!readArray(is, array.back()))
+			return is;
+		if (!(is >> c) || (c != ',' && c != ']')) {
+			is.setstate(ios::failbit);
+			return is;
+		}
+	} while (c == ',');
+
+	return is;
+}
+
+static inline ostream &writeArray(ostream &os, double value)
+{
+	return os << value;
+}
+
+template <class T>
+ostream &writeArray(ostream &os, const vector <T> &array)
+{
+	typename vector <T>::size_type i;
+
+	os << "[";
+	for (i = 0; i < array.size(); i++) {
+		if (i)
+			os << ", ";
+		writeArray(os, array[i]);
+	}
+
+	return os << "]";
+}
+
+#endif
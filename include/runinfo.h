@@ -66,6 +66,7 @@ public:
 			"Verbose = " << ri.verbose << endl <<
 			"List = " << ri.list << endl <<
 			"Compute Resource Bi = " << ri.computeResources << endl;
+		return os;
 	};
 };
 #endif
@@ -0,0 +1,107 @@
+/*
+ * include/solver.h
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <numarray.h>
+
+using namespace std;
+
+/* MGAP instance, as found in the solver model files */
+struct mgapModel {
+	double alpha;
+	NumArray priority;	/* tasks */
+	NumArray period;	/* tasks */
+	NumArray deadline;	/* tasks */
+	NumArray2 cycles;	/* agents x tasks */
+	NumArray2 voltage;	/* agents x levels */
+	NumArray2 frequency;	/* agents x levels */
+};
+
+/* What a solution must pass to be valid */
+enum fitnessTest {
+	EDF_UTILIZATION,	/* per agent utilization up to 1 */
+	RM_UTILIZATION,		/* RM utilization bound */
+	RM_RESPONSE		/* RM response time analysis */
+};
+
+/* How far a solver may go, and where it may start from */
+struct solverLimits {
+	double seconds;		/* wallclock limit, 0 for none */
+	long iterations;	/* generations for the GA, 0 for its default */
+	double upperCut;	/* known upper bound on energy, 0 for none */
+	NumArray3 start;	/* agents x tasks x levels, empty for none */
+	bool relaxIntegrity;
+	int threads;		/* worker threads, 0 for one per core, <0 default */
+	bool opportunistic;	/* CPLEX threads need not repeat their runs */
+	int islands;		/* GA sub-populations, 0 for one */
+	int migration;		/* generations between GA migrations, 0 for 10 */
+	string trace;		/* GA per generation trace file, empty for none */
+	bool warmStart;		/* MIP solvers start from the heuristic, if no start */
+	bool rounding;		/* and round relaxations with it during the search */
+
+	solverLimits(void)
+		:seconds(0.0), iterations(0), upperCut(0.0), relaxIntegrity(false),
+		threads(0), opportunistic(false), islands(0), migration(0),
+		warmStart(true), rounding(true)
+	{
+	}
+};
+
+/* What the solvers report with --statistics */
+struct solverResult {
+	bool good;
+	long etimes;
+	double energy;
+	double gap;
+	double ticks;		/* CPLEX deterministic time, the same on any load */
+};
+
+/*
+ * In-process solver entry point. Drivers create one instance per thread,
+ * so an instance may keep state across calls but not share it. solve()
+ * returns false when the solver could not run at all, an infeasible
+ * instance is reported through result.good.
+ */
+class Solver {
+public:
+	virtual ~Solver() {}
+	virtual bool solve(const mgapModel &model, const solverLimits &limits,
+				solverResult &result) = 0;
+	/* prints the solution found by the last solve() on stdout */
+	virtual void dumpSolution(void) {}
+};
+
+typedef Solver *(*solverFactory)(void);
+
+/* Registry of in-process solvers, keyed by name */
+void registerSolver(const string &name, solverFactory factory);
+Solver *createSolver(const string &name);
+vector <string> solverNames(void);
+
+/* Registers a solver from a static constructor in its own file */
+class SolverRegistration {
+public:
+	SolverRegistration(const char *name, solverFactory factory)
+	{
+		registerSolver(name, factory);
+	}
+};
+
+/* Model IO in the solver model file format */
+ostream &writeModel(ostream &os, const mgapModel &model);
+istream &readModel(istream &is, mgapModel &model);
+
+#endif
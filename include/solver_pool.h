@@ -0,0 +1,75 @@
+/*
+ * include/solver_pool.h
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef SOLVER_POOL_H
+#define SOLVER_POOL_H
+
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+
+#include <solver.h>
+
+/*
+ * One worker thread per configured solver, pinned to a CPU of its own when
+ * the process was given a CPU set narrower than the machine. Every
+ * solve() hands the same model to all workers and returns once the slowest
+ * is done. A solver line whose first word names a registered solver runs
+ * in-process, anything else is run as an external command taking a model
+ * file and printing "good etimes energy".
+ */
+class SolverPool {
+private:
+	struct worker {
+		SolverPool *pool;
+		pthread_t thread;
+		string command;
+		Solver *solver;
+		solverResult result;
+		bool ok;
+	};
+
+	vector <struct worker> workers;
+	string tmpTemplate;
+
+	pthread_mutex_t lock;
+	pthread_cond_t start;
+	pthread_cond_t done;
+	unsigned long sample;	/* bumped for each model handed out */
+	int pending;		/* workers still solving the current one */
+	bool quit;
+	const mgapModel *model;
+	const solverLimits *limits;
+
+	static void *run(void *data);
+	bool executeCommand(const string &command, solverResult &result);
+
+	SolverPool(const SolverPool &);
+	SolverPool &operator=(const SolverPool &);
+public:
+	SolverPool(const vector <string> &solvers,
+		const char *tmpTemplate = "/tmp/fileXXXXXXXX");
+	~SolverPool();
+
+	int size(void)
+	{
+		return workers.size();
+	}
+	void solve(const mgapModel &model, const solverLimits &limits);
+	/* false when solver i failed to run or to report */
+	bool getResult(int i, solverResult &result)
+	{
+		result = workers[i].result;
+		return workers[i].ok;
+	}
+};
+
+#endif
@@ -0,0 +1,153 @@
+/*
+ * include/statistics.h
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <stdint.h>
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Counter-based generator: draw i of a stream is a function of the seed,
+ * the stream number and i only, so streams can be handed to threads, or
+ * to samples, without any state shared between them.
+ */
+class RandomStream {
+private:
+	uint64_t key;
+	uint64_t counter;
+	bool haveSpare;		/* normal() draws its deviates in pairs */
+	double spare;
+
+	static uint64_t mix(uint64_t z)
+	{
+		/* splitmix64 finalizer */
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+
+		return z ^ (z >> 31);
+	}
+public:
+	RandomStream(uint64_t seed = 0, uint64_t stream = 0)
+	{
+		setStream(seed, stream);
+	}
+	void setStream(uint64_t seed, uint64_t stream)
+	{
+		key = mix(seed + mix(stream + 0x9e3779b97f4a7c15ULL));
+		counter = 0;
+		haveSpare = false;
+	}
+
+	uint64_t next(void)
+	{
+		return mix(key + ++counter * 0x9e3779b97f4a7c15ULL);
+	}
+	/* [0, 1) */
+	double real(void)
+	{
+		return (next() >> 11) * (1.0 / 9007199254740992.0);
+	}
+	/* [min, max) */
+	double uniform(double min, double max)
+	{
+		return min + real() * (max - min);
+	}
+	/* [min, max], as Akaroa's UniformInt */
+	long uniformInt(long min, long max)
+	{
+		return min + (long)(real() * (max - min + 1));
+	}
+	double normal(double mean, double sd);
+};
+
+/* Run parameters, named as in the Akaroa parameter files */
+struct statisticsParams {
+	double relError;	/* RelError: relative half width to stop at */
+	double confidence;	/* Confidence: of the intervals */
+	unsigned long minObs;	/* MinObs: of every parameter before stopping */
+	unsigned long maxObs;	/* MaxObs: stop anyway, 0 for never */
+	uint64_t seed;		/* Seed: of the adapter's random stream */
+
+	statisticsParams(void)
+		:relError(0.05), confidence(0.95), minObs(100), maxObs(0),
+		seed(0)
+	{
+	}
+	/* "Key = Value" lines, a warning for each key that is not supported */
+	bool read(const char *filename);
+};
+
+/*
+ * Sequential confidence interval estimation of the mean of several
+ * parameters by batch means. Each parameter starts with batches of one
+ * observation; once MAX_BATCHES batches are full, adjacent ones are merged
+ * and the batch size doubles. Each parameter is tested at checkpoints,
+ * every MIN_BATCHES closed batches once it has minObs observations, and
+ * the run is over when the last test of every stopping parameter gave an
+ * interval within relError of its mean. There is no transient detection:
+ * minObs stands for it, and keeps a parameter with no variance from
+ * stopping the run at its first batches.
+ */
+class SequentialEstimator {
+private:
+	enum { MIN_BATCHES = 10, MAX_BATCHES = 64 };
+
+	struct parameter {
+		unsigned long count;		/* observations */
+		unsigned long batchSize;
+		unsigned long inBatch;		/* observations in the open batch */
+		double batchSum;
+		vector <double> batches;	/* closed batch means */
+		bool converged;			/* at the last checkpoint */
+		bool stopping;			/* over() waits for it */
+	};
+
+	statisticsParams params;
+	vector <struct parameter> parameters;
+
+	bool converged(int param);
+public:
+	SequentialEstimator(int nparams = 0,
+		const statisticsParams &params = statisticsParams());
+
+	void reset(int nparams);
+	int size(void)
+	{
+		return parameters.size();
+	}
+	const statisticsParams &getParams(void)
+	{
+		return params;
+	}
+
+	/* param counts from 0 */
+	void observe(int param, double value);
+	/* whether over() waits for param to converge, true by default */
+	void setStopping(int param, bool stopping)
+	{
+		parameters[param].stopping = stopping;
+	}
+	bool over(void);
+	/* false until param has enough batches for an interval */
+	bool estimate(int param, double &mean, double &delta, double &variance,
+			unsigned long &count);
+	/* Akaroa's table: Param Estimate Delta Conf Var Count */
+	void report(ostream &os);
+};
+
+/* two sided quantile of the Student t with dof degrees of freedom */
+double studentQuantile(double confidence, int dof);
+
+#endif
@@ -11,10 +11,8 @@
 #ifndef TASK_H
 #define TASK_H
 
-#include <ilcplex/ilocplex.h>
-ILOSTLBEGIN
-
 #include <cmath>
+#include <iomanip>
 #include <iostream>
 
 using namespace std;
@@ -33,9 +31,10 @@ private:
 	double Ij;
 //	IloNumArray resources;
 public:
-	Task(IloEnv &env) //:resources(env)
+	Task(void)
 	{
-		period = deadline = wcec = computation = Ip = Ib = Ij = 0.0;
+		priority = 0;
+		period = deadline = wcec = computation = Ip = Ib = Ia = Ij = 0.0;
 	}
 	~Task()
 	{
@@ -0,0 +1,90 @@
+#!/bin/bash
+
+# Compares the RM solvers on the same models: the utilization bound with the
+# exact test in a callback (rm_exact), the linearized response bound
+# (rm_enrico) and the scheduling points (rm_points).
+
+SCHED_HOME=/opt/hydra/Hydra
+SOLVERS="rm_exact rm_enrico rm_points"
+OUT=.
+export PATH=$PATH:$SCHED_HOME/src
+
+# maximum time of each execution (10min)
+TIME_LIMIT=600
+
+show_help()
+{
+	echo "$0 <option> <model files>"
+	echo "-c CORPUS			- solve the models of a corpus instead"
+	echo "-d TIME_LIMIT($TIME_LIMIT)	- time limit to cplex solver"
+	echo "-o OUT($OUT)			- directory of the results"
+	echo "-j THREADS			- CPLEX threads, 0 for one per core"
+}
+
+# command line parsing
+while getopts "h?c:d:o:j:" opt; do
+	case "$opt" in
+	h|\?)
+		show_help
+		exit 0
+		;;
+	c)
+		CORPUS=$OPTARG
+		;;
+	d)
+		TIME_LIMIT=$OPTARG
+		;;
+	o)
+		OUT=$OPTARG
+		;;
+	j)
+		SOLVER_OPTS="-j $OPTARG"
+		;;
+	*)
+		echo "invalid option"
+		exit -1
+		;;
+	esac
+done
+
+shift $((OPTIND-1))
+
+[ "$1" = "--" ] && shift
+
+if [ -n "$CORPUS" ] ; then
+	MODELS="-m $CORPUS"
+elif [ $# -gt 0 ] ; then
+	MODELS="$*"
+else
+	show_help
+	exit -1
+fi
+
+mkdir -p $OUT
+for s in $SOLVERS ; do
+	echo "$s ($(date))"
+	solver_mgap_$s -b -d $TIME_LIMIT $SOLVER_OPTS $MODELS > $OUT/$s.txt
+done
+
+# model feasibility time energy gap ticks, one line per model in every file.
+# Energies are not compared: each solver reports its own objective, and
+# rm_enrico leaves the idle energy out of it.
+echo "solver models feasible mean_time_s mean_ticks mean_gap"
+for s in $SOLVERS ; do
+	awk -v s=$s '
+	{
+		models++
+		if ($2 == "1") {
+			feasible++
+			time += $3
+			ticks += $6
+			gap += $5
+		}
+	}
+	END {
+		printf "%s %d %d %.3f %.1f %.3f\n", s, models, feasible,
+			feasible ? time / feasible / 1000000 : 0,
+			feasible ? ticks / feasible : 0,
+			feasible ? gap / feasible : 0
+	}' $OUT/$s.txt
+done
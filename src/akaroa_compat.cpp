@@ -0,0 +1,93 @@
+/*
+ * src/akaroa_compat.cpp
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stdlib.h>
+
+#include <akaroa_compat.h>
+
+#ifndef HAVE_AKAROA
+/* Akaroa keeps one simulation per process, so does the adapter */
+static statisticsParams *ak_params;
+static SequentialEstimator *ak_estimator;
+static RandomStream ak_stream;
+static bool ak_reported;
+
+static statisticsParams &params(void)
+{
+	if (!ak_params) {
+		const char *filename = getenv("HYDRA_AK_PARAMS");
+
+		ak_params = new statisticsParams();
+		if (filename && !ak_params->read(filename))
+			cerr << "WARNING: could not read '" << filename
+				<< "', using the default parameters" << endl;
+		ak_stream.setStream(ak_params->seed, 0);
+	}
+
+	return *ak_params;
+}
+
+SequentialEstimator &akEstimator(void)
+{
+	if (!ak_estimator)
+		ak_estimator = new SequentialEstimator(0, params());
+
+	return *ak_estimator;
+}
+
+void AkDeclareParameters(int nparams)
+{
+	akEstimator().reset(nparams);
+	ak_reported = false;
+}
+
+void AkParamObservation(int param, double value)
+{
+	if (param >= 1 && param <= akEstimator().size())
+		akEstimator().observe(param - 1, value);
+}
+
+int AkSimulationOver(void)
+{
+	if (!akEstimator().over())
+		return 0;
+
+	if (!ak_reported) {
+		akEstimator().report(cout);
+		ak_reported = true;
+	}
+
+	return 1;
+}
+
+double AkRandomReal(void)
+{
+	params();
+	return ak_stream.real();
+}
+
+double Uniform(double min, double max)
+{
+	params();
+	return ak_stream.uniform(min, max);
+}
+
+long UniformInt(long min, long max)
+{
+	params();
+	return ak_stream.uniformInt(min, max);
+}
+
+double Normal(double mean, double sd)
+{
+	params();
+	return ak_stream.normal(mean, sd);
+}
+#endif
@@ -13,98 +13,95 @@
 #include <errno.h>
 #include <math.h>
 #include <float.h>
+#include <assert.h>
 
 #include <analysis.h>
 #include <gcd_hash.h>
 
+#include <fstream>
 #include <string>
 
 /* Constructors */
-SchedulabilityAnalysis::SchedulabilityAnalysis(IloEnv &env, runInfo runtime)
+SchedulabilityAnalysis::SchedulabilityAnalysis(runInfo runtime)
 	:tasks(_tasks), frequencies(_frequencies), voltages(_voltages),
-	pdyn(_pdyn), pidle(_pidle), assignment(_assignment),
-	resourcePriorities(_resourcePriorities),
+	pdyn(_pdyn), pidle(_pidle),
 	nClusters(0), nProcessors(0), nTasks(0), nFrequencies(0), nResources(0),
-	Lp(0.0), runConfig(runtime), fileModel("model.txt"), loaded(false)
+	Lp(0.0), runConfig(runtime), fileModel("model.txt"), loaded(false),
+	incremental(false)
 {
 	runConfig = runtime;
 	if (runConfig.getVerbose())
 		cout << runConfig;
 
-	readModel(env);
+	readModel();
 	distributeTaskFrequencies();
 }
 
-SchedulabilityAnalysis::SchedulabilityAnalysis(IloEnv &env, runInfo runtime, const char *filename,
+SchedulabilityAnalysis::SchedulabilityAnalysis(runInfo runtime, const char *filename,
 						bool useAssignment)
 	:tasks(_tasks), frequencies(_frequencies), voltages(_voltages),
-	pdyn(_pdyn), pidle(_pidle), assignment(_assignment),
-	resourcePriorities(_resourcePriorities),
+	pdyn(_pdyn), pidle(_pidle),
 	nClusters(0), nProcessors(0), nTasks(0), nFrequencies(0), nResources(0),
-	Lp(0.0), runConfig(runtime), fileModel(filename), loaded(false)
+	Lp(0.0), runConfig(runtime), fileModel(filename), loaded(false),
+	incremental(false)
 {
 
 	if (runConfig.getVerbose())
 		cout << runConfig;
 
-	readModel(env);
+	readModel();
 
 	if (useAssignment)
 		distributeTaskFrequencies();
 
 }
 
-SchedulabilityAnalysis::SchedulabilityAnalysis(IloEnv &env, runInfo runtime, int ntask,
-		int nresources, double lp, IloNumArray2 &freqs, IloNumArray2 &volts,
-		vector <class Task> &tset, IloNumArray4 &assig)
+SchedulabilityAnalysis::SchedulabilityAnalysis(runInfo runtime, int ntask,
+		int nresources, double lp, NumArray2 &freqs, NumArray2 &volts,
+		vector <class Task> &tset, const NumArray4 &assig)
 	:frequencies(freqs), voltages(volts),
-	pdyn(_pdyn), pidle(_pidle), assignment(assig),
-	resourcePriorities(_resourcePriorities),
-	nClusters(assig.getSize()), nProcessors(assig[0].getSize()),
-	nTasks(assig[0][0].getSize()), nFrequencies(assig[0][0][0].getSize()),
-	nResources(nresources), tasks(tset), Lp(lp), runConfig(runtime), fileModel(""), loaded(true)
+	pdyn(_pdyn), pidle(_pidle),
+	resourcePriorities(nresources, -1.0),
+	nClusters(assig.size()), nProcessors(assig[0].size()),
+	nTasks(assig[0][0].size()), nFrequencies(assig[0][0][0].size()),
+	nResources(nresources), tasks(tset), Lp(lp), runConfig(runtime), fileModel(""), loaded(true),
+	incremental(false)
 {
-	int i;
-
 	if (runConfig.getVerbose())
 		cout << runConfig;
 
-	for (i = 0; i < nresources; i++)
-		resourcePriorities.add(-1.0);
-
 	assert(ntask != nTask);
+	indexAssignment(assig);
 	distributeTaskFrequencies();
 
 	/* TODO: computePower() */
 }
 
-SchedulabilityAnalysis::SchedulabilityAnalysis(IloEnv &env, runInfo runtime, int ntask,
-		int nresources, double lp, IloNumArray2 &freqs, IloNumArray2 &power_dyn,
-		IloNumArray2 &power_idle, vector <class Task> &tset, IloNumArray4 &assig)
+SchedulabilityAnalysis::SchedulabilityAnalysis(runInfo runtime, int ntask,
+		int nresources, double lp, NumArray2 &freqs, NumArray2 &power_dyn,
+		NumArray2 &power_idle, vector <class Task> &tset, const NumArray4 &assig)
 	:frequencies(freqs), voltages(_voltages),
-	pdyn(power_dyn), pidle(power_idle), assignment(assig),
-	resourcePriorities(_resourcePriorities),
-	nClusters(assig.getSize()), nProcessors(assig[0].getSize()),
-	nTasks(assig[0][0].getSize()), nFrequencies(assig[0][0][0].getSize()),
-	nResources(nresources), tasks(tset), Lp(lp), runConfig(runtime), fileModel(""), loaded(true)
+	pdyn(power_dyn), pidle(power_idle),
+	resourcePriorities(nresources, -1.0),
+	nClusters(assig.size()), nProcessors(assig[0].size()),
+	nTasks(assig[0][0].size()), nFrequencies(assig[0][0][0].size()),
+	nResources(nresources), tasks(tset), Lp(lp), runConfig(runtime), fileModel(""), loaded(true),
+	incremental(false)
 {
-	int i;
-
 	if (runConfig.getVerbose())
 		cout << runConfig;
 
-	for (i = 0; i < nresources; i++)
-		resourcePriorities.add(-1.0);
-
 	assert(ntask != nTask);
+	indexAssignment(assig);
 	distributeTaskFrequencies();
 }
 
 /* IO */
 /* Reads task model, architecture model and power model */
-void SchedulabilityAnalysis::readModel(IloEnv &env)
+void SchedulabilityAnalysis::readModel(void)
 {
 	int ntasks, nresources, i;
+	NumArray4 assignment;
 
 	if (!fileModel)
 		return;
@@ -119,31 +116,40 @@ void SchedulabilityAnalysis::readModel(IloEnv &env)
 	}
 
 	file >> ntasks >> nresources >> Lp;
-	file >> frequencies;
-	file >> pdyn ;
-	file >> pidle;
+	readArray(file, frequencies);
+	readArray(file, pdyn);
+	readArray(file, pidle);
 
 	i = 0;
 	do {
-		class Task t(env);
+		class Task t;
 
 		file >> t;
 
 		tasks.push_back(t);
 	} while (++i < ntasks);
 
-	for (i = 0; i < nresources; i++)
-		resourcePriorities.add(-1.0);
+	resourcePriorities.assign(nresources, -1.0);
+
+	readArray(file, assignment);
 
-	file >> assignment;
+	if (!file || assignment.empty() || assignment[0].empty() ||
+	    assignment[0][0].empty() || assignment[0][0][0].empty()) {
+		cerr << "ERROR: could not parse model file '" << fileModel
+			<< "'" << endl;
 
-	nClusters = assignment.getSize();
-	nProcessors = assignment[0].getSize();
-	nTasks = assignment[0][0].getSize();
+		throw(-1);
+	}
+
+	nClusters = assignment.size();
+	nProcessors = assignment[0].size();
+	nTasks = assignment[0][0].size();
 	assert(ntask != nTask);
-	nFrequencies = assignment[0][0][0].getSize();
+	nFrequencies = assignment[0][0][0].size();
 	nResources = nresources;
 
+	indexAssignment(assignment);
+
 	loaded = true;
 }
 
@@ -276,21 +282,18 @@ long long SchedulabilityAnalysis::computeLCM(void)
 
 long long SchedulabilityAnalysis::computeLCM(int c, int p)
 {
-	int j, k;
+	int *list = &procTasks[(c * nProcessors + p) * nTasks];
+	int j, n = procCount[c * nProcessors + p];
 	long long LCM;
 
 	LCM = 0;
-	for (j = 0; j < nTasks; j++) {
-		for (k = 0; k < nFrequencies; k++) {
-			if (assignment[c][p][j][k] != 0) {
-				long long period = ceil(tasks[j].getPeriod());
+	for (j = 0; j < n; j++) {
+		long long period = ceil(tasks[list[j]].getPeriod());
 
-				if (LCM == 0)
-					LCM = period;
+		if (LCM == 0)
+			LCM = period;
 
-				LCM = lcm(LCM, period);
-			}
-		}
+		LCM = lcm(LCM, period);
 	}
 
 	return LCM;
@@ -298,25 +301,25 @@ long long SchedulabilityAnalysis::computeLCM(int c, int p)
 
 double SchedulabilityAnalysis::computeSystemEnergy(void)
 {
-	int s, i, j, k;
+	int s, i, j;
 	double edyn = 0.0, estat = 0.0;
 
 	double LCM = computeLCM();
 	for (s = 0; s < nClusters; s++)
 		for (i = 0; i < nProcessors; i++) {
+			int *list = &procTasks[(s * nProcessors + i) * nTasks];
+			int n = procCount[s * nProcessors + i];
 			double ui = 0.0;
 			double Pidle = pidle[s][0]; /* dummy getmax() */
 			/* TODO: Investigate if LCM must be per processor */
 
-			for (j = 0; j < nTasks; j++) {
-				for (k = 0; k < nFrequencies; k++) {
-					double u = tasks[j].getUtilization();
-					if (assignment[s][i][j][k] != 0) {
-						ui += u;
-						edyn += floor(LCM / tasks[j].getPeriod()) *
-							(u * LCM * pdyn[s][k]);
-					}
-				}
+			for (j = 0; j < n; j++) {
+				class Task &t = tasks[list[j]];
+				double u = t.getUtilization();
+
+				ui += u;
+				edyn += floor(LCM / t.getPeriod()) *
+					(u * LCM * pdyn[s][taskLevel[list[j]]]);
 			}
 
 			if (ui > 0)
@@ -326,9 +329,28 @@ double SchedulabilityAnalysis::computeSystemEnergy(void)
 	return edyn + estat;
 }
 
+/*
+ * processor_utilization: utilization of processor (s, i), plus the
+ * switching share when Lp is in place
+ * @complexity: O(ntasks in the processor)
+ */
+void SchedulabilityAnalysis::processorUtilization(int s, int i, double &ui, double &si, int &n)
+{
+	int *list = &procTasks[(s * nProcessors + i) * nTasks];
+	int j;
+
+	ui = si = 0.0;
+	n = procCount[s * nProcessors + i];
+	for (j = 0; j < n; j++) {
+		ui += tasks[list[j]].getUtilization();
+		if (Lp > 0.0)
+			si += tasks[list[j]].getIa() / tasks[list[j]].getPeriod();
+	}
+}
+
 bool SchedulabilityAnalysis::evaluateUtilization(double bound, double &u)
 {
-	int s, i, j, k;
+	int s, i;
 	double sum = 0.0;
 
 	if (runConfig.getVerbose()) {
@@ -341,18 +363,10 @@ bool SchedulabilityAnalysis::evaluateUtilization(double bound, double &u)
 		computeArchitectureInfluence();
 	for (s = 0; s < nClusters; s++)
 		for (i = 0; i < nProcessors; i++) {
-			double ui = 0.0;
-			double si = 0.0;
-			int n = 0;
+			double ui, si;
+			int n;
 
-			for (j = 0; j < nTasks; j++)
-				for (k = 0; k < nFrequencies; k++)
-					if (assignment[s][i][j][k] != 0) {
-						ui += tasks[j].getUtilization();
-						n++;
-						if (Lp > 0.0)
-							si += tasks[j].getIa() / tasks[j].getPeriod();
-					}
+			processorUtilization(s, i, ui, si, n);
 			if (runConfig.getVerbose())
 				cout << "U[" << s << "," << i << "] = " <<
 					std::fixed << std::setw(21) << std::setprecision(4) <<
@@ -371,25 +385,17 @@ bool SchedulabilityAnalysis::evaluateUtilization(double bound, double &u)
 
 void SchedulabilityAnalysis::computeTotalUtilization(double &u)
 {
-	int s, i, j, k;
+	int s, i;
 	double sum = 0.0;
 
 	if (Lp > 0.0)
 		computeArchitectureInfluence();
 	for (s = 0; s < nClusters; s++)
 		for (i = 0; i < nProcessors; i++) {
-			double ui = 0.0;
-			double si = 0.0;
-			int n = 0;
+			double ui, si;
+			int n;
 
-			for (j = 0; j < nTasks; j++)
-				for (k = 0; k < nFrequencies; k++)
-					if (assignment[s][i][j][k] != 0) {
-						ui += tasks[j].getUtilization();
-						n++;
-						if (Lp > 0.0)
-							si += tasks[j].getIa() / tasks[j].getPeriod();
-					}
+			processorUtilization(s, i, ui, si, n);
 			if (runConfig.getVerbose())
 				cout << "U[" << s << "," << i << "] = " <<
 					std::fixed << std::setw(21) << std::setprecision(4) <<
@@ -407,19 +413,16 @@ void SchedulabilityAnalysis::computeTotalUtilization(double &u)
 }
 
 /*
- * distributeTaskFrequencies: Compute resource priorities
- * @complexity: O(nClusters x nProcessors x ntasks x nFrequencies)
+ * distributeTaskFrequencies: Compute each task computation time
+ * @complexity: O(ntasks)
  */
 void SchedulabilityAnalysis::distributeTaskFrequencies()
 {
-	int s, i, j, k;
+	int j;
 
-	for (s = 0; s < nClusters; s++)
-		for (i = 0; i < nProcessors; i++)
-			for (j = 0; j < nTasks; j++)
-				for (k = 0; k < nFrequencies; k++)
-					if (assignment[s][i][j][k] != 0)
-						tasks[j].setComputation(frequencies[i][k]);
+	for (j = 0; j < nTasks; j++)
+		if (taskCluster[j] >= 0)
+			tasks[j].setComputation(frequencies[taskProcessor[j]][taskLevel[j]]);
 }
 
 /*
@@ -430,7 +433,7 @@ void SchedulabilityAnalysis::distributeTaskFrequencies()
  */
 void SchedulabilityAnalysis::computeResourcePriorities()
 {
-	IloNumArray *p;
+	NumArray *p;
 	int i, j;
 
 	p = &resourcePriorities;
@@ -482,62 +485,260 @@ void SchedulabilityAnalysis::computeExclusionInfluency()
 
 }
 
-void SchedulabilityAnalysis::computePrecedenceInfluency()
+/*
+ * compute_task_precedence_influency: fixed point of the response of task j
+ * against the hp-set of its processor, iterating up from Ip
+ * @parameter j: task index
+ * @parameter Ip: starting point, any value not above the response
+ * @complexity: O(hp(j)) per iteration
+ */
+void SchedulabilityAnalysis::computeTaskPrecedenceInfluency(int j, double Ip)
 {
-	int s, i, j, k, p, t;
+	int p, n, *hp;
 	int success;
-	double Ip, Ipa;
+	double base, Ipa;
+
+	hp = &procTasks[processorSlot(j) * nTasks];
+	n = procCount[processorSlot(j)];
+	base = tasks[j].getComputation() + tasks[j].getIb() + tasks[j].getIa();
+	if (Ip < base)
+		Ip = base;
+
+	success = 0;
+	while (!success && Ip <= tasks[j].getDeadline()) {
+		Ipa = Ip;
+		Ip = base;
+		/* hp-set is sorted by decreasing priority */
+		for (p = 0; p < n && tasks[hp[p]].getPriority() > tasks[j].getPriority(); p++)
+			Ip += tasks[hp[p]].getPrecedenceInfluence(Ipa);
+
+		success = (fabs(Ip - Ipa) <= DBL_EPSILON);
+	}
+	tasks[j].setIp(Ip);
+}
 
-	for (s = 0; s < nClusters; s++)
-		for (i = 0; i < nProcessors; i++)
-			for (j = 0; j < nTasks; j++) {
-				for (k = 0; k < nFrequencies; k++)
-					if (assignment[s][i][j][k] != 0) {
-						Ip = tasks[j].getComputation() + tasks[j].getIb() + tasks[j].getIa();
-						success = 0;
-						while (!success && Ip <= tasks[j].getDeadline()) {
-							Ipa = Ip;
-							Ip = tasks[j].getComputation() + tasks[j].getIb() + tasks[j].getIa();
-							for (p = 0; p < nTasks; p++)
-								for (t = 0; t < nFrequencies; t++)
-									if (assignment[s][i][p][t] != 0)
-										if (tasks[j].getPriority() < tasks[p].getPriority())
-											Ip += tasks[p].getPrecedenceInfluence(Ipa);
-
-							success = (fabs(Ip - Ipa) <= DBL_EPSILON);
-						}
-						tasks[j].setIp(Ip);
-					}
-			}
+/*
+ * compute_precedence_influency: response of each task whose interference
+ * changed since the last analysis. Warm tasks restart from their last
+ * response, cold ones from C + Ib + Ia.
+ * @complexity: O(ntasks ^ 2) when cold, O(touched tasks x hp) otherwise
+ */
+void SchedulabilityAnalysis::computePrecedenceInfluency()
+{
+	unsigned int d;
+
+	for (d = 0; d < dirtyTasks.size(); d++) {
+		int j = dirtyTasks[d];
+
+		if (taskCluster[j] >= 0)
+			computeTaskPrecedenceInfluency(j,
+				taskState[j] == RTA_WARM ? tasks[j].getIp() : 0.0);
+		taskState[j] = RTA_CLEAN;
+	}
+	dirtyTasks.clear();
 }
 
+/*
+ * compute_task_architecture_influence: switching influence over task j
+ * from the tasks in the other processors of cluster s
+ * @complexity: O(ntasks in the cluster)
+ */
 double SchedulabilityAnalysis::computeTaskArchitectureInfluence(int s, int i, int j)
 {
-	int p, t, o;
+	int o, p;
 	double numi = 0.0;
 
-	for (o = 0; o < nProcessors; o++) {
-		if (o == i)
+	for (o = s * nProcessors; o < (s + 1) * nProcessors; o++) {
+		int *list = &procTasks[o * nTasks];
+
+		if (o == s * nProcessors + i)
 			continue;
-		for (p = 0; p < nTasks; p++)
-			for (t = 0; t < nFrequencies; t++)
-				if (assignment[s][o][p][t] != 0)
-					numi += ceil(tasks[j].getPeriod() / tasks[p].getPeriod()) * 2.0;
+		for (p = 0; p < procCount[o]; p++)
+			numi += ceil(tasks[j].getPeriod() / tasks[list[p]].getPeriod()) * 2.0;
 	}
 
 	return (2.0 * Lp + numi * Lp);
 }
 
 void SchedulabilityAnalysis::computeArchitectureInfluence()
+{
+	int j;
+
+	for (j = 0; j < nTasks; j++)
+		if (taskCluster[j] >= 0)
+			tasks[j].setIa(computeTaskArchitectureInfluence(taskCluster[j],
+						taskProcessor[j], j));
+}
+
+/*
+ * index_assignment: builds the placement index and the hp-sets out of the
+ * assignment. A task takes the nonzero entry with the largest value.
+ * @complexity: O(nClusters x nProcessors x ntasks x nFrequencies)
+ */
+void SchedulabilityAnalysis::indexAssignment(const NumArray4 &assignment)
 {
 	int s, i, j, k;
+	vector <double> best(nTasks, 0.0);
+
+	taskCluster.assign(nTasks, -1);
+	taskProcessor.assign(nTasks, -1);
+	taskLevel.assign(nTasks, -1);
+	procTasks.assign(nClusters * nProcessors * nTasks, -1);
+	procCount.assign(nClusters * nProcessors, 0);
+	taskState.assign(nTasks, RTA_CLEAN);
+	dirtyTasks.clear();
+	dirtyTasks.reserve(nTasks);
 
 	for (s = 0; s < nClusters; s++)
 		for (i = 0; i < nProcessors; i++)
 			for (j = 0; j < nTasks; j++)
 				for (k = 0; k < nFrequencies; k++)
-					if (assignment[s][i][j][k] != 0)
-						tasks[j].setIa(computeTaskArchitectureInfluence(s, i, j));
+					if (assignment[s][i][j][k] != 0 &&
+					    fabs(assignment[s][i][j][k]) >= best[j]) {
+						best[j] = fabs(assignment[s][i][j][k]);
+						taskCluster[j] = s;
+						taskProcessor[j] = i;
+						taskLevel[j] = k;
+					}
+
+	for (j = 0; j < nTasks; j++)
+		if (taskCluster[j] >= 0)
+			insertProcessorTask(processorSlot(j), j);
+
+	markAllTasks(RTA_COLD);
+}
+
+/* Keeps the hp-set of proc sorted by decreasing priority, O(n(proc)) */
+void SchedulabilityAnalysis::insertProcessorTask(int proc, int task)
+{
+	int *list = &procTasks[proc * nTasks];
+	int n = procCount[proc]++;
+
+	while (n > 0 && tasks[list[n - 1]].getPriority() < tasks[task].getPriority()) {
+		list[n] = list[n - 1];
+		n--;
+	}
+	list[n] = task;
+}
+
+void SchedulabilityAnalysis::removeProcessorTask(int proc, int task)
+{
+	int *list = &procTasks[proc * nTasks];
+	int n = procCount[proc];
+	int p;
+
+	for (p = 0; p < n && list[p] != task; p++)
+		;
+	for (; p < n - 1; p++)
+		list[p] = list[p + 1];
+	procCount[proc] = p;
+}
+
+void SchedulabilityAnalysis::markTask(int task, char state)
+{
+	if (taskState[task] == RTA_CLEAN)
+		dirtyTasks.push_back(task);
+	if (taskState[task] < state)
+		taskState[task] = state;
+}
+
+void SchedulabilityAnalysis::markAllTasks(char state)
+{
+	int j;
+
+	for (j = 0; j < nTasks; j++)
+		markTask(j, state);
+}
+
+/* Marks the tasks of proc with lower priority than task */
+void SchedulabilityAnalysis::markLowerPriority(int proc, int task, char state)
+{
+	int *list = &procTasks[proc * nTasks];
+	int p;
+
+	for (p = procCount[proc] - 1; p >= 0; p--) {
+		if (tasks[list[p]].getPriority() >= tasks[task].getPriority())
+			break;
+		markTask(list[p], state);
+	}
+}
+
+/* Ai depends on every other processor of the cluster */
+void SchedulabilityAnalysis::markCluster(int cluster, char state)
+{
+	int i, p;
+
+	for (i = cluster * nProcessors; i < (cluster + 1) * nProcessors; i++)
+		for (p = 0; p < procCount[i]; p++)
+			markTask(procTasks[i * nTasks + p], state);
+}
+
+void SchedulabilityAnalysis::setIncremental(bool incremental)
+{
+	this->incremental = incremental;
+}
+
+/*
+ * move_task: places task on (cluster, processor, level) and marks the
+ * responses the next computeAnalysis() has to revisit: the task itself
+ * and the lower priority tasks of the processors it left and joined.
+ * Those whose interference can only have grown keep their last response
+ * as a warm start. Callers changing the task WCEC do it before moving.
+ * The assignment given at construction is not updated.
+ * @complexity: O(ntasks in the touched processors)
+ */
+void SchedulabilityAnalysis::moveTask(int task, int cluster, int processor, int level)
+{
+	int from = taskCluster[task] >= 0 ? processorSlot(task) : -1;
+	int to = cluster * nProcessors + processor;
+	double c = tasks[task].getComputation();
+
+	if (from >= 0)
+		removeProcessorTask(from, task);
+	tasks[task].setComputation(frequencies[processor][level]);
+	insertProcessorTask(to, task);
+	taskCluster[task] = cluster;
+	taskProcessor[task] = processor;
+	taskLevel[task] = level;
+
+	if (from == to && tasks[task].getComputation() >= c) {
+		markTask(task, RTA_WARM);
+		markLowerPriority(to, task, RTA_WARM);
+	} else {
+		markTask(task, RTA_COLD);
+		if (from >= 0)
+			markLowerPriority(from, task, RTA_COLD);
+		markLowerPriority(to, task, from == to ? RTA_COLD : RTA_WARM);
+	}
+
+	if (Lp > 0.0) {
+		if (from >= 0)
+			markCluster(from / nProcessors, RTA_COLD);
+		markCluster(cluster, RTA_COLD);
+	}
+}
+
+/*
+ * unassign_task: takes task out of its processor, its response is zeroed
+ * @complexity: O(ntasks in the processor)
+ */
+void SchedulabilityAnalysis::unassignTask(int task)
+{
+	int from;
+
+	if (taskCluster[task] < 0)
+		return;
+
+	from = processorSlot(task);
+	removeProcessorTask(from, task);
+	taskCluster[task] = -1;
+	taskProcessor[task] = -1;
+	taskLevel[task] = -1;
+	tasks[task].setIp(0.0);
+
+	markLowerPriority(from, task, RTA_COLD);
+	if (Lp > 0.0)
+		markCluster(from / nProcessors, RTA_COLD);
 }
 
 /*
@@ -564,6 +765,10 @@ void SchedulabilityAnalysis::computeAnalysis()
 	if (runConfig.getComputeResources())
 		computeExclusionInfluency();
 
+	/* Bi may move with any computation, restart everything */
+	if (!incremental || runConfig.getComputeResources())
+		markAllTasks(RTA_COLD);
+
 	if (Lp > 0.0)
 		computeArchitectureInfluence();
 	/* O(ntasks ^ 2) */
@@ -586,7 +791,7 @@ void SchedulabilityAnalysis::computeAnalysis()
  */
 void SchedulabilityAnalysis::printTaskModel()
 {
-	int s, i, j, k;
+	int s, i, j;
 
 	cout << endl;
 	cout << "**************" << endl;
@@ -608,11 +813,10 @@ void SchedulabilityAnalysis::printTaskModel()
 				std::setw(21) << "Frequency" << endl;
 
 			for (j = 0; j < nTasks; j++)
-				for (k = 0; k < nFrequencies; k++)
-					if (assignment[s][i][j][k] != 0)
-						cout << std::setw(21) << j + 1 <<
-							tasks[j] <<
-							std::setw(21) << frequencies[i][k] << endl;
+				if (taskCluster[j] == s && taskProcessor[j] == i)
+					cout << std::setw(21) << j + 1 <<
+						tasks[j] <<
+						std::setw(21) << frequencies[i][taskLevel[j]] << endl;
 		}
 	}
 
@@ -657,7 +861,7 @@ void SchedulabilityAnalysis::printTaskModel()
  */
 void SchedulabilityAnalysis::printTaskInfluencies()
 {
-	int s, i, j, k;
+	int s, i, j;
 
 	cout << endl;
 	cout << "*************" << endl;
@@ -674,19 +878,18 @@ void SchedulabilityAnalysis::printTaskInfluencies()
 				std::setw(21) << "Ii" << endl;
 
 			for (j = 0; j < nTasks; j++)
-				for (k = 0; k < nFrequencies; k++)
-					if (assignment[s][i][j][k] != 0) {
-						cout << std::setw(21) << j + 1 <<
-							std::fixed << std::setw(21) <<
-								std::setprecision(6) << tasks[j].getIa() <<
-							std::fixed << std::setw(21) <<
-								std::setprecision(6) << tasks[j].getIb() <<
-							std::fixed << std::setw(21) <<
-								std::setprecision(6) << tasks[j].getIj() <<
-							std::fixed << std::setw(21) <<
-								std::setprecision(6) << tasks[j].getIp() <<
-							endl;
-					}
+				if (taskCluster[j] == s && taskProcessor[j] == i) {
+					cout << std::setw(21) << j + 1 <<
+						std::fixed << std::setw(21) <<
+							std::setprecision(6) << tasks[j].getIa() <<
+						std::fixed << std::setw(21) <<
+							std::setprecision(6) << tasks[j].getIb() <<
+						std::fixed << std::setw(21) <<
+							std::setprecision(6) << tasks[j].getIj() <<
+						std::fixed << std::setw(21) <<
+							std::setprecision(6) << tasks[j].getIp() <<
+						endl;
+				}
 		}
 	}
 }
@@ -698,7 +901,7 @@ void SchedulabilityAnalysis::printTaskInfluencies()
  */
 void SchedulabilityAnalysis::printTaskAnalysis()
 {
-	int s, i, j, k;
+	int s, i, j;
 
 	cout << endl;
 	cout << "************" << endl;
@@ -718,31 +921,30 @@ void SchedulabilityAnalysis::printTaskAnalysis()
 				std::setw(21) << "(Di - Ri)" << endl;
 
 			for (j = 0; j < nTasks; j++)
-				for (k = 0; k < nFrequencies; k++)
-					if (assignment[s][i][j][k] != 0) {
-						cout << std::setw(21) << j + 1 <<
-							std::fixed << std::setw(21) <<
-								std::setprecision(6) <<
-								tasks[j].getComputation() <<
-							std::fixed << std::setw(21) <<
-								std::setprecision(6) << tasks[j].getIp() <<
-							std::fixed << std::setw(21) <<
-								std::setprecision(6) <<
-								tasks[j].getResponse() <<
-							std::fixed << std::setw(21) <<
-								std::setprecision(6) <<
-								tasks[j].getPeriod() <<
-							std::fixed << std::setw(21) <<
-								std::setprecision(6) <<
-								tasks[j].getDeadline() <<
-							std::fixed << std::setw(21) <<
-								std::setprecision(6) <<
-								tasks[j].getDeadline() - tasks[j].getIp() <<
-							std::fixed << std::setw(21) <<
-								std::setprecision(6) <<
-							tasks[j].getDeadline() - tasks[j].getResponse() <<
-							endl;
-					}
+				if (taskCluster[j] == s && taskProcessor[j] == i) {
+					cout << std::setw(21) << j + 1 <<
+						std::fixed << std::setw(21) <<
+							std::setprecision(6) <<
+							tasks[j].getComputation() <<
+						std::fixed << std::setw(21) <<
+							std::setprecision(6) << tasks[j].getIp() <<
+						std::fixed << std::setw(21) <<
+							std::setprecision(6) <<
+							tasks[j].getResponse() <<
+						std::fixed << std::setw(21) <<
+							std::setprecision(6) <<
+							tasks[j].getPeriod() <<
+						std::fixed << std::setw(21) <<
+							std::setprecision(6) <<
+							tasks[j].getDeadline() <<
+						std::fixed << std::setw(21) <<
+							std::setprecision(6) <<
+							tasks[j].getDeadline() - tasks[j].getIp() <<
+						std::fixed << std::setw(21) <<
+							std::setprecision(6) <<
+						tasks[j].getDeadline() - tasks[j].getResponse() <<
+						endl;
+				}
 		}
 	}
 }
@@ -0,0 +1,60 @@
+/*
+ * src/coefficients.cpp
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <gcd_hash.h>
+#include <coefficients.h>
+
+/*
+ * compute: energy is the dynamic energy of the task jobs over the
+ * hyperperiod plus the idle energy of the time they leave free
+ * @complexity: O(nAgents x nTasks x nLevels)
+ */
+void mgapCoefficients::compute(const mgapModel &model, double Pidle)
+{
+	const NumArray2 &cycles = model.cycles;
+	const NumArray2 &voltage = model.voltage;
+	const NumArray2 &frequency = model.frequency;
+	const NumArray &period = model.period;
+	int i, j, k, n;
+
+	nAgents = cycles.size();
+	nTasks = period.size();
+	nLevels = nAgents ? frequency[0].size() : 0;
+	LCM = computeLCM(period);
+
+	C.resize(nAgents * nTasks * nLevels);
+	U.resize(C.size());
+	energy.resize(C.size());
+	for (i = 0; i < nAgents; i++)
+		for (j = 0; j < nTasks; j++)
+			for (k = 0; k < nLevels; k++) {
+				n = index(i, j, k);
+				C[n] = cycles[i][j] / (frequency[i][k]);
+				U[n] = C[n] / period[j];
+				energy[n] = model.alpha * (LCM / period[j]) *
+					cycles[i][j] * (voltage[i][k] * voltage[i][k]);
+				energy[n] += LCM * (1.0 - U[n]) * Pidle;
+			}
+}
+
+/* The tensors are written with every digit */
+ostream &writeCoefficients(ostream &os, const mgapCoefficients &coef)
+{
+	streamsize precision = os.precision(17);
+
+	os << coef.nAgents << " " << coef.nTasks << " " << coef.nLevels << " "
+		<< coef.LCM << endl;
+	writeArray(os, coef.C) << endl;
+	writeArray(os, coef.U) << endl;
+	writeArray(os, coef.energy) << endl;
+	os.precision(precision);
+
+	return os;
+}
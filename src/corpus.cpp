@@ -0,0 +1,275 @@
+/*
+ * src/corpus.cpp
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <corpus.h>
+
+/* Readers */
+Corpus::Corpus(void)
+	:fd(-1), base(NULL), length(0), header(NULL), offsets(NULL)
+{
+}
+
+Corpus::~Corpus()
+{
+	close();
+}
+
+bool Corpus::open(const char *filename)
+{
+	struct stat st;
+	void *map;
+
+	close();
+
+	fd = ::open(filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(*header)) {
+		close();
+		return false;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		close();
+		return false;
+	}
+	base = (const char *)map;
+	length = st.st_size;
+	header = (const struct corpusHeader *)base;
+
+	if (memcmp(header->magic, CORPUS_MAGIC, sizeof(header->magic)) ||
+	    header->version != CORPUS_VERSION ||
+	    header->index % sizeof(uint64_t) ||
+	    header->index > length ||
+	    (length - header->index) / sizeof(uint64_t) < header->nmodels) {
+		close();
+		return false;
+	}
+	offsets = (const uint64_t *)(base + header->index);
+
+	return true;
+}
+
+void Corpus::close(void)
+{
+	if (base)
+		munmap((void *)base, length);
+	if (fd >= 0)
+		::close(fd);
+	fd = -1;
+	base = NULL;
+	length = 0;
+	header = NULL;
+	offsets = NULL;
+}
+
+/*
+ * record: points r at model i inside the mapping
+ * @complexity: O(1)
+ */
+bool Corpus::record(int i, struct corpusRecord &r)
+{
+	const struct corpusRecordHeader *rh;
+	const double *data;
+	uint64_t offset, count;
+
+	if (!header || i < 0 || i >= (int)header->nmodels)
+		return false;
+
+	offset = offsets[i];
+	if (offset % sizeof(double) || offset > length ||
+	    length - offset < sizeof(*rh))
+		return false;
+
+	rh = (const struct corpusRecordHeader *)(base + offset);
+	count = 3 * (uint64_t)rh->ntasks +
+		(uint64_t)rh->nagents * rh->ntasks +
+		2 * (uint64_t)rh->nagents * rh->nlevels;
+	if ((length - offset - sizeof(*rh)) / sizeof(double) < count)
+		return false;
+
+	data = (const double *)(rh + 1);
+	r.ntasks = rh->ntasks;
+	r.nagents = rh->nagents;
+	r.nlevels = rh->nlevels;
+	r.alpha = rh->alpha;
+	r.priority = data;
+	r.period = r.priority + r.ntasks;
+	r.deadline = r.period + r.ntasks;
+	r.cycles = r.deadline + r.ntasks;
+	r.voltage = r.cycles + r.nagents * r.ntasks;
+	r.frequency = r.voltage + r.nagents * r.nlevels;
+
+	return true;
+}
+
+/*
+ * get: copies model i out of the mapping
+ * @complexity: O(nagents x (ntasks + nlevels))
+ */
+bool Corpus::get(int i, mgapModel &model)
+{
+	struct corpusRecord r;
+	int a;
+
+	if (!record(i, r))
+		return false;
+
+	model.alpha = r.alpha;
+	model.priority.assign(r.priority, r.priority + r.ntasks);
+	model.period.assign(r.period, r.period + r.ntasks);
+	model.deadline.assign(r.deadline, r.deadline + r.ntasks);
+	model.cycles.resize(r.nagents);
+	model.voltage.resize(r.nagents);
+	model.frequency.resize(r.nagents);
+	for (a = 0; a < r.nagents; a++) {
+		model.cycles[a].assign(r.cycles + a * r.ntasks,
+					r.cycles + (a + 1) * r.ntasks);
+		model.voltage[a].assign(r.voltage + a * r.nlevels,
+					r.voltage + (a + 1) * r.nlevels);
+		model.frequency[a].assign(r.frequency + a * r.nlevels,
+					r.frequency + (a + 1) * r.nlevels);
+	}
+
+	return true;
+}
+
+bool Corpus::isCorpus(const char *filename)
+{
+	char magic[sizeof(((struct corpusHeader *)0)->magic)];
+	FILE *file = fopen(filename, "r");
+	bool ret;
+
+	if (!file)
+		return false;
+
+	ret = fread(magic, sizeof(magic), 1, file) == 1 &&
+		!memcmp(magic, CORPUS_MAGIC, sizeof(magic));
+	fclose(file);
+
+	return ret;
+}
+
+/* Writers */
+CorpusWriter::CorpusWriter(void)
+	:file(NULL), position(0)
+{
+}
+
+CorpusWriter::~CorpusWriter()
+{
+	close();
+}
+
+bool CorpusWriter::write(const void *data, size_t size)
+{
+	if (fwrite(data, size, 1, file) != 1)
+		return false;
+	position += size;
+
+	return true;
+}
+
+bool CorpusWriter::write(const NumArray &array)
+{
+	return array.empty() || write(&array[0], array.size() * sizeof(double));
+}
+
+bool CorpusWriter::open(const char *filename)
+{
+	struct corpusHeader header;
+
+	close();
+
+	file = fopen(filename, "w");
+	if (!file)
+		return false;
+
+	/* rewritten once the index is known */
+	memset(&header, 0, sizeof(header));
+	position = 0;
+	offsets.clear();
+
+	return write(&header, sizeof(header));
+}
+
+bool CorpusWriter::add(const mgapModel &model)
+{
+	struct corpusRecordHeader rh;
+	unsigned int a, ntasks, nagents, nlevels;
+	uint64_t offset = position;
+	bool ret;
+
+	if (!file || model.cycles.empty() || model.frequency.empty())
+		return false;
+
+	ntasks = model.period.size();
+	nagents = model.cycles.size();
+	nlevels = model.frequency[0].size();
+	if (model.priority.size() != ntasks || model.deadline.size() != ntasks ||
+	    model.voltage.size() != nagents || model.frequency.size() != nagents)
+		return false;
+	for (a = 0; a < nagents; a++)
+		if (model.cycles[a].size() != ntasks ||
+		    model.voltage[a].size() != nlevels ||
+		    model.frequency[a].size() != nlevels)
+			return false;
+
+	memset(&rh, 0, sizeof(rh));
+	rh.ntasks = ntasks;
+	rh.nagents = nagents;
+	rh.nlevels = nlevels;
+	rh.alpha = model.alpha;
+
+	ret = write(&rh, sizeof(rh)) && write(model.priority) &&
+		write(model.period) && write(model.deadline);
+	for (a = 0; ret && a < nagents; a++)
+		ret = write(model.cycles[a]);
+	for (a = 0; ret && a < nagents; a++)
+		ret = write(model.voltage[a]);
+	for (a = 0; ret && a < nagents; a++)
+		ret = write(model.frequency[a]);
+	if (ret)
+		offsets.push_back(offset);
+
+	return ret;
+}
+
+bool CorpusWriter::close(void)
+{
+	struct corpusHeader header;
+	bool ret;
+
+	if (!file)
+		return true;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CORPUS_MAGIC, sizeof(header.magic));
+	header.version = CORPUS_VERSION;
+	header.nmodels = offsets.size();
+	header.index = position;
+
+	ret = offsets.empty() ||
+		write(&offsets[0], offsets.size() * sizeof(uint64_t));
+	ret = ret && fseek(file, 0, SEEK_SET) == 0 &&
+		fwrite(&header, sizeof(header), 1, file) == 1;
+	ret = fclose(file) == 0 && ret;
+	file = NULL;
+
+	return ret;
+}
@@ -0,0 +1,71 @@
+/*
+ * src/cplex_solver.cpp
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <cplex_solver.h>
+
+long get_execution_time(struct timeval s, struct timeval e)
+{
+	struct timeval diff;
+
+	timersub(&e, &s, &diff);
+
+	return diff.tv_sec * 1000000 + diff.tv_usec;
+}
+
+void dumpConfigurationInfo(mgapModel &mgap, const NumArray3 &x)
+{
+	const NumArray2 &cycles = mgap.cycles;
+	int nAgents = cycles.size();
+	int nTasks = mgap.period.size();
+	int nLevels = mgap.frequency[0].size();
+	struct runInfo runtime;
+	double sp;
+	int s, i, j, k;
+	vector <class Task> tasks;
+	NumArray4 dec(1, NumArray3(nAgents, NumArray2(nTasks, NumArray(nLevels))));
+
+	runtime.setVerbose(true);
+	runtime.setList(false);
+
+	for (s = 0; s < 1; s++)
+		for (i = 0; i < nAgents; i++)
+			for (j = 0; j < nTasks; j++)
+				for (k = 0; k < nLevels; k++)
+					dec[s][i][j][k] = x[i][j][k];
+	tasks.clear();
+	for (j = 0; j < nTasks; j++) {
+		Task t;
+
+		t.setPriority(mgap.priority[j]);
+		t.setPeriod(mgap.period[j]);
+		t.setDeadline(mgap.deadline[j]);
+		t.setIp(0.0); /* do not touch for now */
+		t.setIb(0.0);/* do not touch for now */
+		t.setIa(0.0); /* do not touch for now */
+		t.setIj(0.0); /* do not touch for now */
+		for (i = 0; i < nAgents; i++)
+			for (k = 0; k < nLevels; k++)
+				if (dec[0][i][j][k])
+					t.setWcec(cycles[i][j]);
+		tasks.push_back(t);
+	}
+
+	SchedulabilityAnalysis sched(runtime, nTasks,
+					0, /* nresources */
+					0.0, /* Lp */
+					mgap.frequency, mgap.voltage, tasks, dec);
+
+	sched.computeAnalysis();
+	sched.evaluateResponse(sp);
+	sched.computeTotalUtilization(sp);
+	tasks.clear();
+	cout << "decision variable: " << endl;
+	writeArray(cout, dec[0]) << endl;
+}
@@ -0,0 +1,188 @@
+/*
+ * src/evaluator.cpp
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <math.h>
+
+#include <evaluator.h>
+
+/* Constructors */
+FeasibilityEvaluator::FeasibilityEvaluator(const NumArray &priority,
+		const NumArray &period, const NumArray &deadline,
+		const NumArray2 &cycles, const NumArray2 &frequency,
+		const NumArray2 &voltage)
+	:nAgents(cycles.size()), nTasks(period.size()), nLevels(frequency[0].size()),
+	cycles(cycles), frequencies(frequency), voltages(voltage),
+	tasks(period.size()), values(nAgents * nTasks * nLevels, 0.0),
+	taskAgent(nTasks, -1), taskLevel(nTasks, -1),
+	sched(runInfo(), nTasks,
+		0, /* nresources */
+		0.0, /* Lp */
+		frequencies, voltages, tasks,
+		NumArray4(1, NumArray3(nAgents, NumArray2(nTasks, NumArray(nLevels, 0.0)))))
+{
+	initTasks(priority, period, deadline);
+	sched.setIncremental(true);
+}
+
+/* A copy starts over with every task unassigned */
+FeasibilityEvaluator::FeasibilityEvaluator(const FeasibilityEvaluator &evaluator)
+	:nAgents(evaluator.nAgents), nTasks(evaluator.nTasks), nLevels(evaluator.nLevels),
+	cycles(evaluator.cycles), frequencies(evaluator.frequencies),
+	voltages(evaluator.voltages), tasks(evaluator.tasks),
+	values(evaluator.values.size(), 0.0),
+	taskAgent(nTasks, -1), taskLevel(nTasks, -1),
+	sched(runInfo(), nTasks,
+		0, /* nresources */
+		0.0, /* Lp */
+		frequencies, voltages, tasks,
+		NumArray4(1, NumArray3(nAgents, NumArray2(nTasks, NumArray(nLevels, 0.0)))))
+{
+	int j;
+
+	for (j = 0; j < nTasks; j++) {
+		tasks[j].setIp(0.0);
+		tasks[j].setIa(0.0);
+	}
+	sched.setIncremental(true);
+}
+
+void FeasibilityEvaluator::initTasks(const NumArray &priority,
+		const NumArray &period, const NumArray &deadline)
+{
+	int j;
+
+	for (j = 0; j < nTasks; j++) {
+		tasks[j].setPriority(priority[j]);
+		tasks[j].setPeriod(period[j]);
+		tasks[j].setDeadline(deadline[j]);
+		tasks[j].setIp(0.0); /* do not touch for now */
+		tasks[j].setIb(0.0);/* do not touch for now */
+		tasks[j].setIa(0.0); /* do not touch for now */
+		tasks[j].setIj(0.0); /* do not touch for now */
+	}
+}
+
+/* moveTask: the analysis side of a placement change */
+void FeasibilityEvaluator::moveTask(int task, int agent, int level)
+{
+	if (agent < 0) {
+		sched.unassignTask(task);
+	} else {
+		tasks[task].setWcec(cycles[agent][task]);
+		sched.moveTask(task, 0, agent, level);
+	}
+	taskAgent[task] = agent;
+	taskLevel[task] = level;
+}
+
+/*
+ * update: moves the tasks whose placement differs from the one the
+ * analysis holds. As when indexing an assignment, a task takes the nonzero
+ * value with the largest magnitude.
+ * @complexity: O(nAgents x ntasks x nLevels) + O(moved tasks x ntasks)
+ */
+void FeasibilityEvaluator::update()
+{
+	int i, j, k, agent, level;
+	double best;
+
+	for (j = 0; j < nTasks; j++) {
+		agent = level = -1;
+		best = 0.0;
+		for (i = 0; i < nAgents; i++)
+			for (k = 0; k < nLevels; k++)
+				if (value(i, j, k) != 0 && fabs(value(i, j, k)) >= best) {
+					best = fabs(value(i, j, k));
+					agent = i;
+					level = k;
+				}
+
+		if (agent != taskAgent[j] || level != taskLevel[j])
+			moveTask(j, agent, level);
+	}
+}
+
+/*
+ * place: moves task alone, a no-op when it is already there
+ * @complexity: O(ntasks in the touched processors)
+ */
+void FeasibilityEvaluator::place(int task, int agent, int level)
+{
+	if (agent == taskAgent[task] && level == taskLevel[task])
+		return;
+
+	if (taskAgent[task] >= 0)
+		value(taskAgent[task], task, taskLevel[task]) = 0.0;
+	if (agent >= 0)
+		value(agent, task, level) = 1.0;
+	moveTask(task, agent, level);
+}
+
+bool FeasibilityEvaluator::responseHolds()
+{
+	double sp;
+
+	sched.computeAnalysis();
+
+	return sched.evaluateResponse(sp);
+}
+
+bool FeasibilityEvaluator::utilizationHolds(double bound)
+{
+	double u;
+
+	return sched.evaluateUtilization(bound, u);
+}
+
+bool FeasibilityEvaluator::evaluateResponse()
+{
+	update();
+
+	return responseHolds();
+}
+
+bool FeasibilityEvaluator::evaluateUtilization(double bound)
+{
+	update();
+
+	return utilizationHolds(bound);
+}
+
+/*
+ * conflict: after evaluateResponse() failed, the tasks of agent that miss
+ * a deadline together: the one of highest priority missing its deadline
+ * and those of strictly higher priority, the only ones it sees. They miss
+ * it wherever the other tasks go, and with longer computation times too.
+ * False when no task of agent misses its deadline.
+ * @complexity: O(ntasks)
+ */
+bool FeasibilityEvaluator::conflict(int agent, vector <int> &set)
+{
+	int j, miss = -1;
+
+	set.clear();
+	for (j = 0; j < nTasks; j++) {
+		if (taskAgent[j] != agent)
+			continue;
+		if (tasks[j].getDeadline() < tasks[j].getResponse() ||
+				tasks[j].getIp() < 0)
+			if (miss < 0 || tasks[j].getPriority() > tasks[miss].getPriority())
+				miss = j;
+	}
+	if (miss < 0)
+		return false;
+
+	for (j = 0; j < nTasks; j++)
+		if (taskAgent[j] == agent && (j == miss ||
+				tasks[j].getPriority() > tasks[miss].getPriority()))
+			set.push_back(j);
+
+	return true;
+}
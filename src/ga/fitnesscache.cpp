@@ -0,0 +1,68 @@
+#include "fitnesscache.h"
+
+using namespace std;
+
+/* agent and level in one word, -1 when unassigned */
+static inline int pack(const Individual &ind, int task)
+{
+	return ind.isAssigned(task) ?
+		(ind.getAgent(task) << 16) | ind.getLevel(task) : -1;
+}
+
+fitnessCache::fitnessCache(int capacity)
+	:capacity(capacity), nTasks(0), entries(capacity), hashes(capacity),
+	hits(0), misses(0)
+{
+	clear(0);
+}
+
+void fitnessCache::clear(int ntasks)
+{
+	int i;
+
+	nTasks = ntasks;
+	genomes.assign(capacity * nTasks, -1);
+	for (i = 0; i < capacity; i++)
+		entries[i].used = false;
+	hits = misses = 0;
+}
+
+bool fitnessCache::matches(int slot, const Individual &ind) const
+{
+	const int *genome = &genomes[slot * nTasks];
+	int j;
+
+	for (j = 0; j < nTasks; j++)
+		if (genome[j] != pack(ind, j))
+			return false;
+
+	return true;
+}
+
+/*
+ * lookup: FNV-1a over the packed genes
+ * @complexity: O(nTasks)
+ */
+struct fitnessCache::entry &fitnessCache::lookup(const Individual &ind)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	int j, slot;
+
+	for (j = 0; j < nTasks; j++) {
+		hash ^= (uint32_t)pack(ind, j);
+		hash *= 1099511628211ULL;
+	}
+	slot = hash % capacity;
+
+	struct entry &e = entries[slot];
+	if (e.used && hashes[slot] == hash && matches(slot, ind))
+		return e;
+
+	e.used = true;
+	e.validKnown = e.energyKnown = false;
+	hashes[slot] = hash;
+	for (j = 0; j < nTasks; j++)
+		genomes[slot * nTasks + j] = pack(ind, j);
+
+	return e;
+}
@@ -0,0 +1,55 @@
+#ifndef __FITNESSCACHE_H
+#define __FITNESSCACHE_H
+
+#include <stdint.h>
+#include <vector>
+#include "individuals.h"
+
+/*
+ * Bounded cache of genome evaluations, direct mapped on the genome hash.
+ * Entries keep the genome they were computed for, so a hash collision is
+ * a miss, never a wrong answer. A colliding insert evicts the entry.
+ */
+class fitnessCache {
+	public:
+		struct entry {
+			bool used;
+			bool validKnown;
+			bool valid;
+			bool energyKnown;
+			double energy;
+		};
+	private:
+		int capacity;
+		int nTasks;
+		std::vector <struct entry> entries;
+		std::vector <int> genomes;	/* capacity x nTasks, agent:level packed */
+		std::vector <uint64_t> hashes;
+		unsigned long hits, misses;
+
+		bool matches(int slot, const Individual &ind) const;
+	public:
+		fitnessCache(int capacity = 4096);
+		/* forget everything, genomes are now ntasks long */
+		void clear(int ntasks);
+		/* entry for ind, created over whatever held its slot if missing */
+		struct entry &lookup(const Individual &ind);
+		void hit(void)
+		{
+			hits++;
+		}
+		void miss(void)
+		{
+			misses++;
+		}
+		unsigned long getHits(void) const
+		{
+			return hits;
+		}
+		unsigned long getMisses(void) const
+		{
+			return misses;
+		}
+};
+
+#endif
@@ -2,42 +2,157 @@
 #define __FITNESSCALCPGA_H
 
 #include <vector>
-#include <ilcplex/ilocplex.h>
+#include <numarray.h>
+#include <task.h>
+#include <solver.h>
+#include <statistics.h>
+#include <coefficients.h>
+#include <evaluator.h>
 #include "individuals.h"
+#include "fitnesscache.h"
 
+/* Constructive heuristics seeding the population */
+enum seedHeuristic {
+	FIRST_FIT_DECREASING,	/* first agent it fits in */
+	WORST_FIT_DECREASING,	/* least loaded agent it fits in */
+	SEED_HEURISTICS
+};
+
+/* Owns an evaluator of the model, each copy of it getting its own */
+class evaluatorHolder {
+	private:
+		FeasibilityEvaluator *evaluator;
+	public:
+		evaluatorHolder(void)
+			:evaluator(NULL)
+		{
+		}
+		evaluatorHolder(const evaluatorHolder &holder)
+			:evaluator(holder.evaluator ?
+				new FeasibilityEvaluator(*holder.evaluator) : NULL)
+		{
+		}
+		~evaluatorHolder(void)
+		{
+			delete evaluator;
+		}
+		evaluatorHolder &operator=(const evaluatorHolder &holder)
+		{
+			if (this != &holder)
+				reset(holder.evaluator ?
+					new FeasibilityEvaluator(*holder.evaluator) : NULL);
+			return *this;
+		}
+		void reset(FeasibilityEvaluator *e)
+		{
+			delete evaluator;
+			evaluator = e;
+		}
+		FeasibilityEvaluator *operator->() const
+		{
+			return evaluator;
+		}
+};
+
+/*
+ * Fitness and validity of individuals of one model. Calculators share
+ * nothing, so each thread evaluating individuals works on its own copy,
+ * cache and scratch buffers included.
+ */
 class fitnessCalcPGA {
 	private:
-		static IloEnv env;
-		static int nAgents, nTasks, nLevels;
-		static IloNumArray2 cycles, voltage, frequency;
-		static IloNumArray priority;
-		static IloNumArray period;
-		static IloNumArray Deadline;
-		static IloNum Pidle;
-		static double LCM;
-		static double alpha;
+		fitnessTest test;
+		int nAgents, nTasks, nLevels;
+		NumArray2 cycles, voltage, frequency;
+		NumArray priority;
+		NumArray period;
+		NumArray Deadline;
+		mgapCoefficients coef;
+		fitnessCache cache;	/* evaluations of the current model */
+		/* the incremental analysis of the last individual checked */
+		evaluatorHolder evaluator;
+
+		/* order repair() places tasks in, as the tests sum them up */
+		vector <int> placementOrder;
+		/* per task, agent * nLevels + level by increasing energy */
+		vector <int> cheapest;
+		/* per (agent, task), its levels by increasing energy */
+		vector <int> cheapestLevels;
+		/* tasks by decreasing utilization, at their fastest */
+		vector <int> fitOrder;
+
+		/* scratch of the validity tests */
+		vector <double> total;
+		vector <int> count;
+		vector <char> placed;
+		vector <int> raised;	/* task, level it was raised from */
+		vector <char> affected;
+		Individual improved;
+
+		double taskUtilization(int agent, int task, int level) const
+		{
+			return coef.U[coef.index(agent, task, level)];
+		}
+		double energyOf(int agent, int task, int level) const
+		{
+			return coef.energy[coef.index(agent, task, level)];
+		}
+		double utilizationBound(int n) const;
+		bool isUtilizationValid(const Individual &ind);
+		bool loadEvaluator(const Individual &ind);
+		bool isAnalysisValid(const Individual &ind, bool response);
+		void fillAnalysis(const Individual &ind, vector <class Task> &tasks,
+				NumArray4 &dec);
+		bool tryPlace(int task, int agent, int level);
+		int fastestLevel(int agent, int task) const;
+		void setLevel(Individual &ind, int task, int level);
+		bool placeRaising(Individual &ind, int task);
+		bool tryMoves(Individual &ind, int n, const int *task,
+				const int *agent, const int *level);
+		int cheapestLevel(int agent, int task, double room) const;
+		bool improveLevels(Individual &ind);
+		bool improveSwaps(Individual &ind);
 	public:
+		fitnessCalcPGA(void);
 		/* Getters */
-		static int getNTasks()
+		int getNTasks() const
 		{
 			return nTasks;
 		}
-		static int getNAgents()
+		int getNAgents() const
 		{
 			return nAgents;
 		}
-		static int getNLevels()
+		int getNLevels() const
 		{
 			return nLevels;
 		}
-		static void dumpConfigurationInfo(Individual ind);
-		static bool isIndividualValid(Individual ind);
-		static int getTaskGene(int task, Individual ind);
-		static int selectFreeGene(Individual ind);
-		static void feedModel(const char *filename);
-		static void fitIndividual(Individual *individual);
-		static double getFitness(Individual individual);
-		static double getFOPower(Individual individual);
+		void dumpConfigurationInfo(const Individual &ind);
+		bool isIndividualValid(const Individual &ind);
+		void setTest(fitnessTest t)
+		{
+			test = t;
+			cache.clear(nTasks);
+		}
+		unsigned long getCacheHits() const
+		{
+			return cache.getHits();
+		}
+		unsigned long getCacheMisses() const
+		{
+			return cache.getMisses();
+		}
+		void feedModel(const char *filename);
+		void setModel(const mgapModel &model);
+		void fitIndividual(Individual &individual, RandomStream &stream);
+		/* makes ind valid, false when some task fits nowhere */
+		bool repair(Individual &ind);
+		/* local search on a valid ind, true when it got cheaper */
+		bool improve(Individual &ind);
+		/* the seed of heuristic h, repaired and improved if it can be */
+		void seedIndividual(Individual &ind, seedHeuristic h);
+		double getFitness(const Individual &individual);
+		double getFOPower(const Individual &individual);
 };
 
 #endif
@@ -1,8 +1,11 @@
-#include <ilcplex/ilocplex.h>
+#include <math.h>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <algorithm>
 #include <vector>
 #include <string>
-#include <gcd_hash.h>
+#include <numarray.h>
 #include <task.h>
 #include <analysis.h>
 #include <runinfo.h>
@@ -11,42 +14,28 @@
 
 using namespace std;
 
-IloEnv fitnessCalcPGA::env;
-int fitnessCalcPGA::nAgents, fitnessCalcPGA::nTasks, fitnessCalcPGA::nLevels;
-IloNumArray2 fitnessCalcPGA::cycles(env), fitnessCalcPGA::voltage(env), fitnessCalcPGA::frequency(env);
-IloNumArray fitnessCalcPGA::priority(env);
-IloNumArray fitnessCalcPGA::period(env);
-IloNumArray fitnessCalcPGA::Deadline(env);
-IloNum fitnessCalcPGA::Pidle = 0.260;
-double fitnessCalcPGA::LCM;
-double fitnessCalcPGA::alpha;
+fitnessCalcPGA::fitnessCalcPGA(void)
+	:test(EDF_UTILIZATION), nAgents(0), nTasks(0), nLevels(0)
+{
+}
 
-void fitnessCalcPGA::dumpConfigurationInfo(Individual ind)
+/*
+ * fillAnalysis: tasks and decision variable of ind
+ * @complexity: O(nAgents x nTasks x nLevels)
+ */
+void fitnessCalcPGA::fillAnalysis(const Individual &ind,
+				vector <class Task> &tasks, NumArray4 &dec)
 {
-	struct runInfo runtime;
-	double sp;
-	int s, i, j, k;
-	vector <class Task> tasks;
-	IloNumArray4 dec(env, 1);
+	NumArray3 &d = dec[0];
+	int j;
 
-	runtime.setVerbose(true);
-	runtime.setList(false);
+	for (j = 0; j < nTasks; j++)
+		if (ind.isAssigned(j))
+			d[ind.getAgent(j)][j][ind.getLevel(j)] = 1.0;
 
-	for (s = 0; s < 1; s++) {
-		dec[s] = IloNumArray3(env, nAgents);
-		for (i = 0; i < nAgents; i++) {
-			dec[s][i] = IloNumArray2(env, nTasks);
-			for (j = 0; j < nTasks; j++) {
-				dec[s][i][j] = IloNumArray(env, nLevels, 0, 1, ILOINT);
-				for (k = 0; k < nLevels; k++) {
-					dec[s][i][j][k] = ind.getGene(i * (nTasks * nLevels) + j * nLevels + k);
-				}
-			}
-		}
-	}
 	tasks.clear();
 	for (j = 0; j < nTasks; j++) {
-		Task t(env);
+		Task t;
 
 		t.setPriority(priority[j]);
 		t.setPeriod(period[j]);
@@ -55,14 +44,24 @@ void fitnessCalcPGA::dumpConfigurationInfo(Individual ind)
 		t.setIb(0.0);/* do not touch for now */
 		t.setIa(0.0); /* do not touch for now */
 		t.setIj(0.0); /* do not touch for now */
-		for (i = 0; i < nAgents; i++)
-			for (k = 0; k < nLevels; k++)
-				if (dec[0][i][j][k])
-					t.setWcec(cycles[i][j]);
+		if (ind.isAssigned(j))
+			t.setWcec(cycles[ind.getAgent(j)][j]);
 		tasks.push_back(t);
 	}
+}
 
-	SchedulabilityAnalysis sched(env, runtime, nTasks,
+void fitnessCalcPGA::dumpConfigurationInfo(const Individual &ind)
+{
+	NumArray4 dec(1, NumArray3(nAgents, NumArray2(nTasks, NumArray(nLevels, 0.0))));
+	vector <class Task> tasks;
+	struct runInfo runtime;
+	double sp;
+
+	runtime.setVerbose(true);
+	runtime.setList(false);
+
+	fillAnalysis(ind, tasks, dec);
+	SchedulabilityAnalysis sched(runtime, nTasks,
 					0, /* nresources */
 					0.0, /* Lp */
 					frequency, voltage, tasks, dec);
@@ -70,164 +69,711 @@ void fitnessCalcPGA::dumpConfigurationInfo(Individual ind)
 	sched.computeAnalysis();
 	sched.evaluateResponse(sp);
 	sched.computeTotalUtilization(sp);
-	tasks.clear();
-	cout << "decision variable: " << endl << dec[0] << endl;
-	for (s = 0; s < 1; s++) {
-		for (i = 0; i < nAgents; i++) {
-			for (j = 0; j < nTasks; j++) {
-				dec[s][i][j].end();
-			}
-			dec[s][i].end();
+	cout << "decision variable: " << endl;
+	writeArray(cout, dec[0]) << endl;
+}
+
+/*
+ * isUtilizationValid: every task assigned and no agent loaded over 1
+ * @complexity: O(nAgents + nTasks)
+ */
+bool fitnessCalcPGA::isUtilizationValid(const Individual &ind)
+{
+	int i, j;
+
+	total.assign(nAgents, 0.0);
+	for(j = 0; j < nTasks; j++) {
+		if (!ind.isAssigned(j)) {
+			//cerr << "Individual over task " << j << endl;
+			return false;
+		}
+		i = ind.getAgent(j);
+		total[i] += taskUtilization(i, j, ind.getLevel(j));
+	}
+
+	for(i = 0; i < nAgents; i++) {
+		if (total[i] > 1.0) {
+			//cerr << "Individual over agent " << i << " " << total[i] << endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * loadEvaluator: moves the tasks ind places elsewhere than the evaluator
+ * holds, so that only their processors get analysed again. False when
+ * some task is unassigned.
+ * @complexity: O(nTasks) + O(moved tasks x nTasks)
+ */
+bool fitnessCalcPGA::loadEvaluator(const Individual &ind)
+{
+	bool assigned = true;
+	int j;
+
+	for (j = 0; j < nTasks; j++) {
+		if (!ind.isAssigned(j)) {
+			evaluator->place(j, -1, -1);
+			assigned = false;
+		} else {
+			evaluator->place(j, ind.getAgent(j), ind.getLevel(j));
 		}
-		dec[s].end();
 	}
-	dec.end();
+
+	return assigned;
 }
 
-bool fitnessCalcPGA::isIndividualValid(Individual ind)
+bool fitnessCalcPGA::isAnalysisValid(const Individual &ind, bool response)
 {
-	int i, j, k, gene;
+	if (!loadEvaluator(ind))
+		return false;
 
-	for(i = 0; i < nAgents; i++) {
-		double total = 0.0;
-		for(j = 0; j < nTasks; j++) {
-			for(k = 0; k < nLevels; k++) {
-				int index = (i * (nTasks * nLevels) +
-						j * nLevels + k);
+	if (response)
+		return evaluator->responseHolds();
+
+	return evaluator->utilizationHolds(1.0);
+}
+
+bool fitnessCalcPGA::isIndividualValid(const Individual &ind)
+{
+	struct fitnessCache::entry &e = cache.lookup(ind);
+
+	if (e.validKnown) {
+		cache.hit();
+		return e.valid;
+	}
+	cache.miss();
+
+	switch (test) {
+	case RM_UTILIZATION:
+		e.valid = isAnalysisValid(ind, false);
+		break;
+	case RM_RESPONSE:
+		e.valid = isAnalysisValid(ind, true);
+		break;
+	default:
+		e.valid = isUtilizationValid(ind);
+		break;
+	}
+	e.validKnown = true;
+
+	return e.valid;
+}
+
+void fitnessCalcPGA::feedModel(const char *filename)
+{
+	mgapModel model;
+	ifstream file(filename);
+
+	if (!file) {
+		cerr << "ERROR: could not open file '" << filename
+			<< "' for reading" << endl;
+		throw(-1);
+	}
+
+	readModel(file, model);
+	setModel(model);
+}
+
+/* orders tasks by decreasing priority */
+struct higherPriority {
+	const NumArray &priority;
+
+	higherPriority(const NumArray &priority)
+		:priority(priority)
+	{
+	}
+	bool operator()(int a, int b) const
+	{
+		return priority[a] > priority[b];
+	}
+};
+
+/* orders placement options by increasing energy, tasks by decreasing utilization */
+struct lowerCost {
+	const vector <double> &cost;
+
+	lowerCost(const vector <double> &cost)
+		:cost(cost)
+	{
+	}
+	bool operator()(int a, int b) const
+	{
+		return cost[a] < cost[b];
+	}
+};
+
+void fitnessCalcPGA::setModel(const mgapModel &model)
+{
+	vector <double> fastest;
+	int i, j, k, o;
+
+	priority = model.priority;
+	period = model.period;
+	Deadline = model.deadline;
+	cycles = model.cycles;
+	voltage = model.voltage;
+	frequency = model.frequency;
+	nAgents = cycles.size();
+	nTasks = period.size();
+	nLevels = frequency[0].size();
+
+	coef.compute(model);
+	cache.clear(nTasks);
+	evaluator.reset(new FeasibilityEvaluator(priority, period, Deadline,
+				cycles, frequency, voltage));
+	affected.assign(nAgents, 0);
+
+	/* ties keep the task order, as the hp-sets do */
+	placementOrder.resize(nTasks);
+	for (j = 0; j < nTasks; j++)
+		placementOrder[j] = j;
+	stable_sort(placementOrder.begin(), placementOrder.end(),
+			higherPriority(priority));
+
+	cheapest.resize(nTasks * nAgents * nLevels);
+	for (j = 0; j < nTasks; j++) {
+		int *options = &cheapest[j * nAgents * nLevels];
+		vector <double> cost(nAgents * nLevels);
+
+		for (o = 0; o < nAgents * nLevels; o++) {
+			options[o] = o;
+			cost[o] = energyOf(o / nLevels, j, o % nLevels);
+		}
+		stable_sort(options, options + nAgents * nLevels,
+				lowerCost(cost));
+	}
 
-				total += ind.getGene(index) * (cycles[i][j] / (frequency[i][k])) / period[j];
+	cheapestLevels.resize(nAgents * nTasks * nLevels);
+	for (i = 0; i < nAgents; i++)
+		for (j = 0; j < nTasks; j++) {
+			int *levels = &cheapestLevels[(i * nTasks + j) * nLevels];
+			vector <double> cost(nLevels);
 
+			for (k = 0; k < nLevels; k++) {
+				levels[k] = k;
+				cost[k] = energyOf(i, j, k);
 			}
+			stable_sort(levels, levels + nLevels, lowerCost(cost));
 		}
-		if (total > 1.0) {
-			//cerr << "Individual over agent " << i << " " << total << endl;
-			return false;
+
+	/* negated utilization at the fastest level, sorted up */
+	fitOrder.resize(nTasks);
+	fastest.assign(nTasks, 0.0);
+	for (j = 0; j < nTasks; j++) {
+		fitOrder[j] = j;
+		for (o = 0; o < nAgents * nLevels; o++) {
+			double u = taskUtilization(o / nLevels, j, o % nLevels);
+
+			if (o == 0 || -u > fastest[j])
+				fastest[j] = -u;
 		}
 	}
+	stable_sort(fitOrder.begin(), fitOrder.end(), lowerCost(fastest));
+}
+
+/*
+ * fitIndividual: random assignment, each task retried on another agent
+ * and level while its agent is already loaded over 1
+ * @complexity: O(nTasks x tries)
+ */
+void fitnessCalcPGA::fitIndividual(Individual &ind, RandomStream &stream)
+{
+	int i, j, k;
+
+	ind.reset(nTasks);
+	total.assign(nAgents, 0.0);
 
 	for(j = 0; j < nTasks; j++) {
-		int total = 0;
-		for(i = 0; i < nAgents; i++) {
-			for(k = 0; k < nLevels; k++) {
-				int index = (i * (nTasks * nLevels) +
-						j * nLevels + k);
+		int tries = 0;
+		do {
+			i = (int)(stream.real() * nAgents);
+			k = (int)(stream.real() * nLevels);
+		} while (++tries < 1000 && total[i] > 1.0);
+		ind.setGene(j, i, k);
+		total[i] += taskUtilization(i, j, k);
+	}
 
-				total += ind.getGene(index);
+}
 
-			}
-		}
-		if (total != 1) {
-			//cerr << "Individual over task " << j << " " << total << endl;
+/*
+ * tryPlace: places task on (agent, level) when it keeps what is placed so
+ * far valid. Tasks come in placementOrder, so only the agent of task is
+ * checked and, for response times, only task itself is analysed.
+ * @complexity: O(1), O(hp tasks) with response times
+ */
+bool fitnessCalcPGA::tryPlace(int task, int agent, int level)
+{
+	double u = taskUtilization(agent, task, level);
+	int n = count[agent] + 1;
+
+	switch (test) {
+	case RM_UTILIZATION:
+		if (total[agent] + u > ((double)n * (pow(2.0, 1.0 / (double)n) - 1.0)))
+			return false;
+		break;
+	case RM_RESPONSE:
+		evaluator->place(task, agent, level);
+		evaluator->analyse();
+		if (!evaluator->meetsDeadline(task)) {
+			evaluator->place(task, -1, -1);
 			return false;
 		}
+		break;
+	default:
+		if (total[agent] + u > 1.0)
+			return false;
+		break;
 	}
 
+	total[agent] += u;
+	count[agent] = n;
+
 	return true;
 }
-int fitnessCalcPGA::getTaskGene(int task, Individual ind)
+
+/* fastestLevel: of task on agent, the one of least utilization */
+int fitnessCalcPGA::fastestLevel(int agent, int task) const
+{
+	int k, level = 0;
+
+	for (k = 1; k < nLevels; k++)
+		if (taskUtilization(agent, task, k) <
+				taskUtilization(agent, task, level))
+			level = k;
+
+	return level;
+}
+
+/* setLevel: moves the placed task to level, on the agent it is on */
+void fitnessCalcPGA::setLevel(Individual &ind, int task, int level)
 {
-	int i, j, k, gene;
+	int i = ind.getAgent(task);
 
-	for(i = 0; i < nAgents; i++) {
-		for(k = 0; k < nLevels; k++) {
-			gene = ind.getGene(i * (nTasks * nLevels) +
-						task * nLevels + k);
-			if (gene)
-				return (i * (nTasks * nLevels) +
-					task * nLevels + k);
+	total[i] += taskUtilization(i, task, level) -
+		taskUtilization(i, task, ind.getLevel(task));
+	ind.setGene(task, i, level);
+	if (test == RM_RESPONSE)
+		evaluator->place(task, i, level);
+}
+
+/*
+ * placeRaising: places task at its fastest level on the least loaded
+ * agent that takes it, raising the tasks placed there before to their
+ * fastest levels when it does not fit otherwise. Faster tasks only leave
+ * more room to the others, so the placed ones stay valid. The raised
+ * tasks get their levels back on the agents that do not take it.
+ * @complexity: O(nAgents x (nAgents + nTasks x nLevels)) tryPlace
+ */
+bool fitnessCalcPGA::placeRaising(Individual &ind, int task)
+{
+	vector <char> tried(nAgents, 0);
+	int i, b, j, a, r;
+	bool ok = false;
+
+	for (a = 0; a < nAgents && !ok; a++) {
+		for (i = -1, b = 0; b < nAgents; b++)
+			if (!tried[b] && (i < 0 || total[b] < total[i]))
+				i = b;
+		tried[i] = 1;
+
+		ok = tryPlace(task, i, fastestLevel(i, task));
+		if (ok)
+			break;
+
+		raised.clear();
+		for (j = 0; j < nTasks; j++)
+			if (placed[j] && ind.getAgent(j) == i &&
+					ind.getLevel(j) != fastestLevel(i, j)) {
+				raised.push_back(j);
+				raised.push_back(ind.getLevel(j));
+				setLevel(ind, j, fastestLevel(i, j));
+			}
+		if (raised.empty())
+			continue;
+
+		ok = tryPlace(task, i, fastestLevel(i, task));
+		if (!ok)
+			for (r = raised.size() - 2; r >= 0; r -= 2)
+				setLevel(ind, raised[r], raised[r + 1]);
+	}
+	if (ok)
+		ind.setGene(task, i, fastestLevel(i, task));
+
+	return ok;
+}
+
+/*
+ * repair: places the tasks of ind one at a time, each on its own agent and
+ * level when that keeps the placed ones valid and on the cheapest one that
+ * does otherwise. When none does, placeRaising() makes room for it at the
+ * expense of energy, for improve() to win back. Placing tasks as the tests
+ * sum them up makes the result valid exactly when isIndividualValid() says
+ * so.
+ * @complexity: O(nTasks x nAgents x nLevels) checks of tryPlace at most,
+ * O(nTasks x nAgents^2) more with placeRaising
+ */
+bool fitnessCalcPGA::repair(Individual &ind)
+{
+	bool ok = true;
+	int i, j, k, o, c;
+
+	total.assign(nAgents, 0.0);
+	count.assign(nAgents, 0);
+	placed.assign(nTasks, 0);
+	if (ind.getSize() != nTasks)
+		ind.reset(nTasks);
+
+	if (test == RM_RESPONSE)
+		for (j = 0; j < nTasks; j++)
+			evaluator->place(j, -1, -1);
+
+	for (o = 0; o < nTasks && ok; o++) {
+		int *options;
+
+		/* EDF utilization adds up in task order */
+		j = test == EDF_UTILIZATION ? o : placementOrder[o];
+		if (ind.isAssigned(j) &&
+				tryPlace(j, ind.getAgent(j), ind.getLevel(j))) {
+			placed[j] = 1;
+			continue;
 		}
+
+		options = &cheapest[j * nAgents * nLevels];
+		ok = false;
+		for (c = 0; c < nAgents * nLevels && !ok; c++) {
+			i = options[c] / nLevels;
+			k = options[c] % nLevels;
+			if (tryPlace(j, i, k)) {
+				ind.setGene(j, i, k);
+				ok = true;
+			}
+		}
+		if (!ok)
+			ok = placeRaising(ind, j);
+		placed[j] = ok;
+	}
+
+	if (ok) {
+		struct fitnessCache::entry &e = cache.lookup(ind);
+
+		e.valid = e.validKnown = true;
 	}
 
-	cout << "Task " << task << " not assigned"<< endl;
+	return ok;
+}
+
+/* Local search */
+
+#define IMPROVE_PASSES	8	/* over all the tasks, at most */
+
+/*
+ * utilizationBound: what the test admits on an agent running n tasks, a
+ * necessary condition only with response times
+ */
+double fitnessCalcPGA::utilizationBound(int n) const
+{
+	if (test == RM_UTILIZATION)
+		return (double)n * (pow(2.0, 1.0 / (double)n) - 1.0);
+
+	return 1.0;
+}
+
+/* cheapestLevel: of task on agent within room utilization, -1 for none */
+int fitnessCalcPGA::cheapestLevel(int agent, int task, double room) const
+{
+	const int *levels = &cheapestLevels[(agent * nTasks + task) * nLevels];
+	int k;
+
+	for (k = 0; k < nLevels; k++)
+		if (taskUtilization(agent, task, levels[k]) <= room)
+			return levels[k];
 
 	return -1;
 }
 
-void fitnessCalcPGA::feedModel(const char *filename)
+/*
+ * tryMoves: moves task[m] to agent[m] at level[m], m < n <= 2, and keeps
+ * the moves when the agents they touch stay valid, undoing them otherwise.
+ * Only those agents are checked: their utilization from the running
+ * totals and, with response times, the responses of their tasks, which
+ * the incremental analysis recomputes for them alone.
+ * @complexity: O(1), O(nTasks + hp tasks of the agents) with response times
+ */
+bool fitnessCalcPGA::tryMoves(Individual &ind, int n, const int *task,
+				const int *agent, const int *level)
 {
+	int fromAgent[2], fromLevel[2], touched[4], savedCount[4];
+	double savedTotal[4];
+	bool ok = true;
+	int j, m;
+
+	for (m = 0; m < n; m++) {
+		fromAgent[m] = ind.getAgent(task[m]);
+		fromLevel[m] = ind.getLevel(task[m]);
+		touched[2 * m] = fromAgent[m];
+		touched[2 * m + 1] = agent[m];
+	}
+	for (m = 0; m < 2 * n; m++) {
+		savedTotal[m] = total[touched[m]];
+		savedCount[m] = count[touched[m]];
+	}
 
-	ifstream file(filename);
+	for (m = 0; m < n; m++) {
+		j = task[m];
+		total[fromAgent[m]] -= taskUtilization(fromAgent[m], j, fromLevel[m]);
+		count[fromAgent[m]]--;
+		total[agent[m]] += taskUtilization(agent[m], j, level[m]);
+		count[agent[m]]++;
+		ind.setGene(j, agent[m], level[m]);
+	}
+	for (m = 0; m < 2 * n && ok; m++)
+		ok = total[touched[m]] <= utilizationBound(count[touched[m]]);
 
-	if (!file) {
-		cerr << "ERROR: could not open file '" << filename
-			<< "' for reading" << endl;
-		throw(-1);
+	if (ok && test == RM_RESPONSE) {
+		for (m = 0; m < n; m++) {
+			evaluator->place(task[m], agent[m], level[m]);
+			affected[fromAgent[m]] = affected[agent[m]] = 1;
+		}
+		evaluator->analyse();
+		for (j = 0; j < nTasks && ok; j++)
+			if (affected[ind.getAgent(j)])
+				ok = evaluator->meetsDeadline(j);
+		for (m = 0; m < n; m++)
+			affected[fromAgent[m]] = affected[agent[m]] = 0;
+
+		/* analysed again along with the next moves */
+		for (m = n - 1; m >= 0 && !ok; m--)
+			evaluator->place(task[m], fromAgent[m], fromLevel[m]);
 	}
+	if (ok)
+		return true;
 
-	file >> alpha >> priority >> period >> Deadline >> cycles >> voltage >> frequency;
-	nAgents = cycles.getSize();
-	nTasks = period.getSize();
-	nLevels = frequency[0].getSize();
+	for (m = 0; m < 2 * n; m++) {
+		total[touched[m]] = savedTotal[m];
+		count[touched[m]] = savedCount[m];
+	}
+	for (m = n - 1; m >= 0; m--)
+		ind.setGene(task[m], fromAgent[m], fromLevel[m]);
 
-	LCM = computeLCM(period);
+	return false;
 }
 
-void fitnessCalcPGA::fitIndividual(Individual *ind)
+/*
+ * improveLevels: moves each task to the cheapest level, on its agent or
+ * another one, that the agents involved admit
+ * @complexity: O(nTasks x nAgents x nLevels) tryMoves at most
+ */
+bool fitnessCalcPGA::improveLevels(Individual &ind)
 {
-	int i, j, k;
+	bool better = false;
+	int i, j, k, c, a, n;
 
-	ind->setSize(nAgents * nTasks * nLevels);
-	for(i = 0; i < nAgents; i++) {
-		for(j = 0; j < nTasks; j++) {
-			for(k = 0; k < nLevels; k++) {
-				ind->setGene(i * (nTasks * nLevels) +
-						j * nLevels + k, 0);
+	for (j = 0; j < nTasks; j++) {
+		const int *options = &cheapest[j * nAgents * nLevels];
+		double e, u;
+
+		a = ind.getAgent(j);
+		e = energyOf(a, j, ind.getLevel(j));
+		u = taskUtilization(a, j, ind.getLevel(j));
+		for (c = 0; c < nAgents * nLevels; c++) {
+			i = options[c] / nLevels;
+			k = options[c] % nLevels;
+			if (energyOf(i, j, k) >= e)
+				break;
+
+			n = i == a ? count[i] : count[i] + 1;
+			if (total[i] - (i == a ? u : 0.0) +
+					taskUtilization(i, j, k) > utilizationBound(n))
+				continue;
+			if (tryMoves(ind, 1, &j, &i, &k)) {
+				better = true;
+				break;
 			}
 		}
 	}
 
-	for(j = 0; j < nTasks; j++) {
-		int tries = 0;
-		double total = 0.0;
-		do {
-			i = (int)(drand48() * nAgents);
-			k = (int)(drand48() * nLevels);
+	return better;
+}
 
-			total = 0.0;
-			for(int p = 0; p < nTasks; p++) {
-				for(int q = 0; q < nLevels; q++) {
-					int index = (i * (nTasks * nLevels) +
-						p * nLevels + q);
+/*
+ * improveSwaps: exchanges tasks of two agents, each at the cheapest level
+ * that fits in what the other one leaves, when that costs less
+ * @complexity: O(nTasks^2 x nLevels) and a tryMoves per cheaper swap
+ */
+bool fitnessCalcPGA::improveSwaps(Individual &ind)
+{
+	bool better = false;
+	int task[2], agent[2], level[2];
+	int j1, j2, a1, a2, k1, k2;
+
+	for (j1 = 0; j1 < nTasks; j1++) {
+		for (j2 = j1 + 1; j2 < nTasks; j2++) {
+			double delta;
+
+			a1 = ind.getAgent(j1);
+			a2 = ind.getAgent(j2);
+			if (a1 == a2)
+				continue;
+			k1 = ind.getLevel(j1);
+			k2 = ind.getLevel(j2);
+
+			level[0] = cheapestLevel(a2, j1, utilizationBound(count[a2]) -
+					total[a2] + taskUtilization(a2, j2, k2));
+			level[1] = cheapestLevel(a1, j2, utilizationBound(count[a1]) -
+					total[a1] + taskUtilization(a1, j1, k1));
+			if (level[0] < 0 || level[1] < 0)
+				continue;
+
+			delta = energyOf(a2, j1, level[0]) + energyOf(a1, j2, level[1]) -
+				energyOf(a1, j1, k1) - energyOf(a2, j2, k2);
+			if (delta >= 0.0)
+				continue;
+
+			task[0] = j1;
+			task[1] = j2;
+			agent[0] = a2;
+			agent[1] = a1;
+			if (tryMoves(ind, 2, task, agent, level))
+				better = true;
+		}
+	}
 
-					total += ind->getGene(index) * (cycles[i][p] / (frequency[i][q])) / period[p];
+	return better;
+}
 
-				}
+/*
+ * improve: first improvement local search of ind over single task moves,
+ * to another level or agent, and swaps of tasks between agents. Moves are
+ * priced from the energy table and checked on the agents they touch only,
+ * and the result is tested in full before it is kept, as the running sums
+ * may round differently.
+ * @complexity: O(IMPROVE_PASSES x nTasks^2 x nLevels) plus the checks
+ */
+bool fitnessCalcPGA::improve(Individual &ind)
+{
+	bool better = false, moved = true;
+	int i, j, pass;
 
+	if (!isIndividualValid(ind))
+		return false;
+
+	total.assign(nAgents, 0.0);
+	count.assign(nAgents, 0);
+	for (j = 0; j < nTasks; j++) {
+		i = ind.getAgent(j);
+		total[i] += taskUtilization(i, j, ind.getLevel(j));
+		count[i]++;
+	}
+
+	/* the moves are analysed from ind on */
+	if (test == RM_RESPONSE)
+		loadEvaluator(ind);
+
+	improved = ind;
+	for (pass = 0; pass < IMPROVE_PASSES && moved; pass++) {
+		moved = improveLevels(ind);
+		moved = improveSwaps(ind) || moved;
+		better = better || moved;
+	}
+
+	if (better && !isIndividualValid(ind)) {
+		ind.swap(improved);
+		better = false;
+	}
+
+	return better;
+}
+
+/*
+ * seedIndividual: tasks by decreasing utilization, each at its fastest
+ * level on the first (FFD) or least loaded (WFD) agent that it keeps
+ * within the utilization bound of the test. Slow levels early on would
+ * leave no room for the tasks coming later: the seed is repaired, which
+ * places those that fit nowhere, and then improve() lowers the levels.
+ * @complexity: O(nTasks x nAgents x (nAgents + nLevels)) plus the repair
+ * and the local search
+ */
+void fitnessCalcPGA::seedIndividual(Individual &ind, seedHeuristic h)
+{
+	vector <char> tried(nAgents);
+	int i, j, o, a, b, level;
+
+	ind.reset(nTasks);
+	total.assign(nAgents, 0.0);
+	count.assign(nAgents, 0);
+
+	for (o = 0; o < nTasks; o++) {
+		j = fitOrder[o];
+		tried.assign(nAgents, 0);
+
+		for (a = 0; a < nAgents; a++) {
+			double bound, u = 0.0;
+			int n;
+
+			i = a;
+			if (h == WORST_FIT_DECREASING) {
+				for (i = -1, b = 0; b < nAgents; b++)
+					if (!tried[b] && (i < 0 || total[b] < total[i]))
+						i = b;
+				tried[i] = 1;
+			}
+
+			n = count[i] + 1;
+			bound = test == EDF_UTILIZATION ? 1.0 :
+				(double)n * (pow(2.0, 1.0 / (double)n) - 1.0);
+			level = fastestLevel(i, j);
+			u = taskUtilization(i, j, level);
+			if (total[i] + u <= bound) {
+				ind.setGene(j, i, level);
+				total[i] += u;
+				count[i] = n;
+				break;
 			}
-			int index = (i * (nTasks * nLevels) +
-						j * nLevels + k);
-			total += ind->getGene(index) * (cycles[i][j] / (frequency[i][k])) / period[j];
-		} while (++tries < 1000 && total > 1.0);
-		ind->setGene(i * (nTasks * nLevels) +
-				j * nLevels + k, 1);
+		}
 	}
 
+	if (repair(ind))
+		improve(ind);
 }
 
-double fitnessCalcPGA::getFitness(Individual individual)
+double fitnessCalcPGA::getFitness(const Individual &individual)
 {
 
 	/* fi = 1 / Ci */
 	return 1.0 / getFOPower(individual);
 }
 
-double fitnessCalcPGA::getFOPower(Individual individual)
+/*
+ * getFOPower: energy of the assigned tasks over the hyperperiod, cached
+ * per genome along with its validity
+ * @complexity: O(nTasks)
+ */
+double fitnessCalcPGA::getFOPower(const Individual &individual)
 {
+	struct fitnessCache::entry &e = cache.lookup(individual);
 	double power = 0.0;
 	int i, j, k;
 
-	for(i = 0; i < nAgents; i++) {
-		for(j = 0; j < nTasks; j++) {
-			for(k = 0; k < nLevels; k++) {
-				power += ((alpha * (LCM / period[j]) * cycles[i][j] *
-					(voltage[i][k] * voltage[i][k])) +
-					(LCM * (1.0 - (cycles[i][j] / (frequency[i][k]) ) / period[j]) * Pidle)) * individual.getGene(i * (nTasks * nLevels) + j * (nLevels) + k);
-			}
-		}
+	if (e.energyKnown) {
+		cache.hit();
+		return e.energy;
+	}
+	cache.miss();
+
+	for(j = 0; j < nTasks; j++) {
+		if (!individual.isAssigned(j))
+			continue;
+		i = individual.getAgent(j);
+		k = individual.getLevel(j);
+		power += energyOf(i, j, k);
 	}
 
 	if (power >= 0.0 && power <= 0.0)
 		power = std::numeric_limits<double>::max();
+	e.energy = power;
+	e.energyKnown = true;
 
 	return power;
 }
@@ -0,0 +1,450 @@
+/*
+ * src/ga/genetic_solver.cpp
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <sys/time.h>
+#include <math.h>
+#include <float.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <iostream>
+#include <fstream>
+
+#include <solver.h>
+#include <statistics.h>
+#include "fitnesscalcPGA.h"
+#include "population.h"
+#include "individuals.h"
+#include "geneticalgorithm.h"
+
+using namespace std;
+
+static long get_execution_time(struct timeval s, struct timeval e)
+{
+	struct timeval diff;
+
+	timersub(&e, &s, &diff);
+
+	return diff.tv_sec * 1000000 + diff.tv_usec;
+}
+
+#define POPULATION_SIZE		50
+#define MIGRATION_INTERVAL	10	/* generations, by default */
+
+/*
+ * Islands past the first run on threads of their own, started once per
+ * solve and woken for each epoch, the first one on the calling thread.
+ */
+struct epochControl {
+	pthread_mutex_t lock;
+	pthread_cond_t start;
+	pthread_cond_t done;
+	unsigned long epoch;	/* bumped for each epoch */
+	int pending;		/* island threads still in it */
+	bool quit;
+};
+
+/*
+ * One sub-population of an island run. Islands evolve apart, each on its
+ * own thread, for an epoch of generations and then send their fittest
+ * individual to the next island of the ring.
+ */
+struct island {
+	geneticAlgorithm *ga;
+	Population pop, next;
+	int iterations;		/* generations to run at most */
+	int maxEquals;		/* without a new fittest, to stop at */
+	int generations;	/* run so far */
+	int equals;		/* of them without a new fittest */
+	double f;		/* fitness of the fittest */
+	int epoch;		/* generations to run before the next migration */
+	bool started;
+	bool tracing;
+	vector <struct generationStats> trace;	/* one per generation */
+	struct epochControl *control;
+	pthread_t thread;
+
+	island(void)
+		:ga(NULL), pop(POPULATION_SIZE), next(POPULATION_SIZE),
+		iterations(0), maxEquals(0), generations(0), equals(0), f(-1.0),
+		epoch(0), started(false), tracing(false), control(NULL)
+	{
+	}
+	bool active(void)
+	{
+		return pop.getSize() == POPULATION_SIZE &&
+			generations < iterations && equals != maxEquals;
+	}
+};
+
+/* evolves isl for an epoch, generating its population first if needed */
+static void *run_island(void *data)
+{
+	struct island *isl = (struct island *)data;
+	int n;
+
+	if (!isl->started) {
+		isl->ga->generatePopulation(isl->pop, POPULATION_SIZE * 1000);
+		isl->started = true;
+	}
+
+	// Evolve our population until we reach an optimum solution
+	for (n = 0; n < isl->epoch && isl->active(); n++) {
+		double l = isl->pop.getFittest().getFitness();
+
+		isl->generations++;
+		if (fabs(l - isl->f) <= DBL_EPSILON) {
+			isl->equals++;
+		} else {
+			isl->f = l;
+			isl->equals = 0;
+		}
+		isl->ga->evolvePopulation(isl->pop, isl->next);
+		isl->pop.swap(isl->next);
+		if (isl->tracing)
+			isl->trace.push_back(isl->ga->getStats());
+	}
+
+	return NULL;
+}
+
+/* island threads: every epoch of their island, until the solve is over */
+static void *island_thread(void *data)
+{
+	struct island *isl = (struct island *)data;
+	struct epochControl *control = isl->control;
+	unsigned long seen = 0;
+
+	pthread_mutex_lock(&control->lock);
+	for (;;) {
+		while (control->epoch == seen && !control->quit)
+			pthread_cond_wait(&control->start, &control->lock);
+		if (control->quit)
+			break;
+		seen = control->epoch;
+		pthread_mutex_unlock(&control->lock);
+
+		run_island(isl);
+
+		pthread_mutex_lock(&control->lock);
+		if (--control->pending == 0)
+			pthread_cond_signal(&control->done);
+	}
+	pthread_mutex_unlock(&control->lock);
+
+	return NULL;
+}
+
+/*
+ * run_epoch: evolves every island for an epoch, island 0 on the calling
+ * thread, and returns once the slowest is done
+ * @complexity: the slowest island
+ */
+static void run_epoch(vector <struct island> &islands,
+			struct epochControl &control)
+{
+	pthread_mutex_lock(&control.lock);
+	control.pending = islands.size() - 1;
+	control.epoch++;
+	pthread_cond_broadcast(&control.start);
+	pthread_mutex_unlock(&control.lock);
+
+	run_island(&islands[0]);
+
+	pthread_mutex_lock(&control.lock);
+	while (control.pending > 0)
+		pthread_cond_wait(&control.done, &control.lock);
+	pthread_mutex_unlock(&control.lock);
+}
+
+/*
+ * migrate: the fittest of every island replaces the least fit of the
+ * next one, when fitter. Migrants are all picked before any is placed,
+ * so the ring order does not matter.
+ * @complexity: O(islands x population)
+ */
+static void migrate(vector <struct island> &islands)
+{
+	vector <Individual> migrants(islands.size());
+	unsigned int i;
+
+	for (i = 0; i < islands.size(); i++)
+		if (islands[i].pop.getSize() > 0)
+			migrants[i] = islands[i].pop.getFittest();
+
+	for (i = 0; i < islands.size(); i++) {
+		struct island &to = islands[(i + 1) % islands.size()];
+		int w;
+
+		if (islands[i].pop.getSize() == 0 ||
+				to.pop.getSize() != POPULATION_SIZE)
+			continue;
+
+		w = to.pop.getLeastFitIndex();
+		if (migrants[i].getFitness() <= to.pop.getIndividual(w).getFitness())
+			continue;
+		/* a new fittest wakes up an island that had stagnated */
+		if (migrants[i].getFitness() > to.pop.getFittest().getFitness())
+			to.equals = 0;
+		to.pop.setIndividual(w, migrants[i]);
+	}
+}
+
+class GeneticSolver : public Solver {
+private:
+	fitnessTest test;
+	mgapModel mgap;		/* last instance solved */
+	Individual fittest;	/* and its best individual */
+	int generationCount;
+	bool valid;
+	unsigned long cacheHits, cacheMisses;	/* of the last solve */
+	int solves;
+
+	fitnessTest islandTest(int island);
+	double islandMutationRate(int island);
+	void writeTrace(const string &filename, vector <struct island> &islands,
+			long etimes);
+public:
+	GeneticSolver(fitnessTest test)
+		:test(test), generationCount(0), valid(false), cacheHits(0),
+		cacheMisses(0), solves(0)
+	{
+	}
+	bool solve(const mgapModel &model, const solverLimits &limits,
+			solverResult &result);
+	void dumpSolution(void);
+};
+
+/*
+ * Island variants: island 0 runs the solver as configured. RM response
+ * time solvers test every other island with the RM utilization bound,
+ * cheaper and sufficient, and islands past the first mutate half a task
+ * per island index per offspring on average.
+ */
+fitnessTest GeneticSolver::islandTest(int island)
+{
+	if (test == RM_RESPONSE && island % 2)
+		return RM_UTILIZATION;
+
+	return test;
+}
+
+double GeneticSolver::islandMutationRate(int island)
+{
+	return island / (2.0 * mgap.period.size());
+}
+
+/*
+ * writeTrace: one line per island and generation, after a header, then
+ * the evaluations per second of the whole solve. The first solve of the
+ * solver truncates the file and later ones append to it.
+ */
+void GeneticSolver::writeTrace(const string &filename,
+				vector <struct island> &islands, long etimes)
+{
+	ofstream file(filename.c_str(), solves > 1 ? ios::app : ios::trunc);
+	unsigned long evaluations = 0;
+	unsigned int i, g;
+
+	if (!file) {
+		cerr << "ERROR: could not open file '" << filename
+			<< "' for writing" << endl;
+		return;
+	}
+
+	file << "# solve " << solves << endl;
+	file << "# island generation best mean worst valid hit_rate "
+		"selection_us crossover_us mutation_us evaluation_us "
+		"local_search_us" << endl;
+	for (i = 0; i < islands.size(); i++) {
+		for (g = 0; g < islands[i].trace.size(); g++) {
+			struct generationStats &s = islands[i].trace[g];
+			unsigned long lookups = s.hits + s.misses;
+
+			file << i << " " << g + 1 << " " << s.best << " "
+				<< s.mean << " " << s.worst << " " << s.valid << " "
+				<< (lookups ? (double)s.hits / lookups : 0.0) << " "
+				<< s.selection / 1000.0 << " "
+				<< s.crossover / 1000.0 << " "
+				<< s.mutation / 1000.0 << " "
+				<< s.evaluation / 1000.0 << " "
+				<< s.localSearch / 1000.0 << endl;
+		}
+		evaluations += islands[i].ga->getEvaluations();
+	}
+
+	file << "# evaluations " << evaluations << " seconds "
+		<< etimes / 1000000.0 << " per_second "
+		<< (etimes > 0 ? evaluations * 1000000.0 / etimes : 0.0) << endl;
+}
+
+bool GeneticSolver::solve(const mgapModel &model, const solverLimits &limits,
+			solverResult &result)
+{
+	struct timeval st, e;
+	int iteration = limits.iterations > 0 ? limits.iterations : 100;
+	int nislands = limits.islands > 0 ? limits.islands : 1;
+	int migration = limits.migration > 0 ? limits.migration : MIGRATION_INTERVAL;
+	int nthreads = limits.threads;
+	vector <struct island> islands(nislands);
+	struct epochControl control;
+	fitnessCalcPGA calc;
+	uint64_t seed;
+	int i, best;
+	bool running;
+
+	mgap = model;
+	solves++;
+	generationCount = 0;
+	valid = false;
+	cacheHits = cacheMisses = 0;
+	result.good = false;
+	result.etimes = 0;
+	result.energy = 0.0;
+	result.gap = 0.0;
+	result.ticks = 0.0;
+
+	if (nthreads < 0)
+		nthreads = 1;
+	else if (nthreads == 0)
+		nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	/* the threads are shared out among the islands */
+	nthreads = nthreads > nislands ? nthreads / nislands : 1;
+
+	gettimeofday(&st, NULL);
+	/* the whole run follows from this draw on the srandom() seed */
+	seed = random();
+	for (i = 0; i < nislands; i++) {
+		struct island &isl = islands[i];
+
+		calc.setTest(islandTest(i));
+		calc.setModel(mgap);
+		isl.ga = new geneticAlgorithm(calc, nthreads,
+					RandomStream(seed, i).next());
+		isl.ga->setMutationRate(islandMutationRate(i));
+		isl.iterations = iteration;
+		isl.maxEquals = iteration / 10;
+		isl.tracing = !limits.trace.empty();
+		isl.control = &control;
+	}
+
+	pthread_mutex_init(&control.lock, NULL);
+	pthread_cond_init(&control.start, NULL);
+	pthread_cond_init(&control.done, NULL);
+	control.epoch = 0;
+	control.pending = 0;
+	control.quit = false;
+	for (i = 1; i < nislands; i++)
+		pthread_create(&islands[i].thread, NULL, island_thread,
+				&islands[i]);
+
+	do {
+		for (i = 0; i < nislands; i++)
+			islands[i].epoch = migration;
+
+		run_epoch(islands, control);
+		if (nislands > 1)
+			migrate(islands);
+
+		running = false;
+		for (i = 0; i < nislands; i++)
+			running = running || islands[i].active();
+	} while (running);
+
+	pthread_mutex_lock(&control.lock);
+	control.quit = true;
+	pthread_cond_broadcast(&control.start);
+	pthread_mutex_unlock(&control.lock);
+	for (i = 1; i < nislands; i++)
+		pthread_join(islands[i].thread, NULL);
+	pthread_cond_destroy(&control.done);
+	pthread_cond_destroy(&control.start);
+	pthread_mutex_destroy(&control.lock);
+	gettimeofday(&e, NULL);
+	result.etimes = get_execution_time(st, e);
+	if (!limits.trace.empty())
+		writeTrace(limits.trace, islands, result.etimes);
+
+	best = -1;
+	for (i = 0; i < nislands; i++) {
+		struct island &isl = islands[i];
+
+		if (isl.generations > generationCount)
+			generationCount = isl.generations;
+		cacheHits += isl.ga->getCacheHits();
+		cacheMisses += isl.ga->getCacheMisses();
+		if (isl.pop.getSize() > 0 && (best < 0 ||
+				islands[best].pop.getFittest().getFitness() <=
+				isl.pop.getFittest().getFitness()))
+			best = i;
+	}
+
+	if (best >= 0) {
+		fittest = islands[best].pop.getFittest();
+		calc.setTest(test);
+		valid = calc.isIndividualValid(fittest);
+	}
+	if (valid) {
+		result.good = true;
+		result.energy = calc.getFOPower(fittest);
+	} else {
+		result.etimes = 0;
+	}
+	cacheHits += calc.getCacheHits();
+	cacheMisses += calc.getCacheMisses();
+
+	for (i = 0; i < nislands; i++)
+		delete islands[i].ga;
+
+	if (best < 0) {
+		cout << "Could not generate valid individuals" << endl;
+		return false;
+	}
+
+	return true;
+}
+
+void GeneticSolver::dumpSolution(void)
+{
+	fitnessCalcPGA calc;
+
+	cout << "Fitness cache: " << cacheHits << " hits, " << cacheMisses
+		<< " misses" << endl;
+	if (!valid) {
+		cout << "Solution found is not feasible" << endl;
+		return;
+	}
+
+	calc.setTest(test);
+	calc.setModel(mgap);
+	cout << "Generation: " << generationCount << endl;
+	calc.dumpConfigurationInfo(fittest);
+}
+
+static Solver *createGeneticSolver(void)
+{
+	return new GeneticSolver(EDF_UTILIZATION);
+}
+
+static Solver *createGeneticRMUtilSolver(void)
+{
+	return new GeneticSolver(RM_UTILIZATION);
+}
+
+static Solver *createGeneticRMRespSolver(void)
+{
+	return new GeneticSolver(RM_RESPONSE);
+}
+
+static SolverRegistration registration("ga", createGeneticSolver);
+static SolverRegistration rmUtilRegistration("ga_rm_util",
+						createGeneticRMUtilSolver);
+static SolverRegistration rmRespRegistration("ga_rm_resp",
+						createGeneticRMRespSolver);
@@ -1,26 +1,295 @@
 #include <cmath>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <unistd.h>
 #include "population.h"
 #include "fitnesscalcPGA.h"
 #include "individuals.h"
 #include "geneticalgorithm.h"
 #include <iostream>
 
-geneticAlgorithm::geneticAlgorithm(void)
+/* Initial candidates are generated and tested in rounds of a fixed size */
+#define CANDIDATES_PER_ROUND	64
+
+/*
+ * Random streams: 0 selects parents, 1 + 2k generates candidate k and
+ * 2 + 2n mutates offspring n, counting offspring over all generations
+ */
+#define SELECTION_STREAM	0
+#define CANDIDATE_STREAM(k)	(1 + 2 * (uint64_t)(k))
+#define OFFSPRING_STREAM(n)	(2 + 2 * (uint64_t)(n))
+
+/* monotonic clock, in nanoseconds */
+static uint64_t now(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+
+	return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+geneticAlgorithm::geneticAlgorithm(const fitnessCalcPGA &calc, int nthreads,
+					uint64_t seed)
+	:seed(seed), selection(seed, SELECTION_STREAM), generation(0),
+	candidate(0), round(0), pending(0), quit(false),
+	evaluations(0)
 {
+	struct worker w;
+	int i;
+
 	uniformRate = 0.5;
 	mutationRate = 0.0;
 	tournamentSize = 5;
+	localSearch = 2;
 	elitism = true;
+
+	if (nthreads <= 0)
+		nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nthreads <= 0)
+		nthreads = 1;
+
+	memset(&stats, 0, sizeof(stats));
+	w.ga = this;
+	w.calc = calc;
+	w.stats = stats;
+	workers.resize(nthreads, w);
+
+	pthread_mutex_init(&lock, NULL);
+	pthread_cond_init(&start, NULL);
+	pthread_cond_init(&done, NULL);
+
+	/* worker 0 is the calling thread */
+	for (i = 0; i < nthreads; i++) {
+		workers[i].ga = this;
+		if (i > 0)
+			pthread_create(&workers[i].thread, NULL, run, &workers[i]);
+	}
+}
+
+geneticAlgorithm::~geneticAlgorithm()
+{
+	unsigned int i;
+
+	pthread_mutex_lock(&lock);
+	quit = true;
+	pthread_cond_broadcast(&start);
+	pthread_mutex_unlock(&lock);
+
+	for (i = 1; i < workers.size(); i++)
+		pthread_join(workers[i].thread, NULL);
+
+	pthread_cond_destroy(&done);
+	pthread_cond_destroy(&start);
+	pthread_mutex_destroy(&lock);
+}
+
+/* worker threads: the jobs of every round, until the algorithm goes away */
+void *geneticAlgorithm::run(void *data)
+{
+	struct worker *w = (struct worker *)data;
+	geneticAlgorithm *ga = w->ga;
+	unsigned long seen = 0;
+
+	pthread_mutex_lock(&ga->lock);
+	for (;;) {
+		while (ga->round == seen && !ga->quit)
+			pthread_cond_wait(&ga->start, &ga->lock);
+		if (ga->quit)
+			break;
+		seen = ga->round;
+		pthread_mutex_unlock(&ga->lock);
+
+		ga->runJobs(*w);
+
+		pthread_mutex_lock(&ga->lock);
+		if (--ga->pending == 0)
+			pthread_cond_signal(&ga->done);
+	}
+	pthread_mutex_unlock(&ga->lock);
+
+	return NULL;
+}
+
+/* takes jobs of the current round on w until there are none left */
+void geneticAlgorithm::runJobs(struct worker &w)
+{
+	int i;
+
+	for (;;) {
+		pthread_mutex_lock(&lock);
+		i = next++;
+		pthread_mutex_unlock(&lock);
+		if (i >= count)
+			break;
+
+		if (kind == CANDIDATES)
+			generateCandidate(w, i);
+		else if (kind == OFFSPRING)
+			breedOffspring(w, first + i);
+		else
+			improveOffspring(w, i);
+	}
+}
+
+/* runs jobs first to first + count - 1 of kind on all workers */
+void geneticAlgorithm::runRound(roundKind kind, int first, int count)
+{
+	pthread_mutex_lock(&lock);
+	this->kind = kind;
+	this->first = first;
+	this->count = count;
+	next = 0;
+	pending = workers.size() - 1;
+	round++;
+	pthread_cond_broadcast(&start);
+	pthread_mutex_unlock(&lock);
+
+	runJobs(workers[0]);
+
+	pthread_mutex_lock(&lock);
+	while (pending > 0)
+		pthread_cond_wait(&done, &lock);
+	pthread_mutex_unlock(&lock);
+}
+
+void geneticAlgorithm::generateCandidate(struct worker &w, int i)
+{
+	fitnessCalcPGA &calc = w.calc;
+	Individual &ind = candidates[i];
+	unsigned long k = candidate + i;
+	RandomStream stream(seed, CANDIDATE_STREAM(k));
+
+	if (k < (unsigned long)seeded) {
+		ind = seeds[k % SEED_HEURISTICS];
+		if (k >= SEED_HEURISTICS)
+			perturb(calc, ind, stream);
+	} else {
+		calc.fitIndividual(ind, stream);
+	}
+	candidateValid[i] = calc.repair(ind);
+	if (candidateValid[i])
+		ind.setFitness(calc.getFitness(ind));
+	w.stats.evaluations++;
+}
+
+/* a mutant replaces the child it came from when it can be repaired */
+void geneticAlgorithm::breedOffspring(struct worker &w, int i)
+{
+	fitnessCalcPGA &calc = w.calc;
+	Individual &child = offspring->getIndividual(i);
+	RandomStream stream(seed, OFFSPRING_STREAM(generation *
+					offspring->getSize() + i));
+
+	uint64_t t0, t1, t2;
+
+	t0 = now();
+	if (crossover(calc, parents->getIndividual(mates[2 * i]),
+			parents->getIndividual(mates[2 * i + 1]), child, stream))
+		w.stats.valid++;
+	t1 = now();
+	w.mutant = child;
+	if (mutate(calc, w.mutant, stream) && calc.repair(w.mutant))
+		child.swap(w.mutant);
+	t2 = now();
+	child.setFitness(calc.getFitness(child));
+	w.stats.evaluations++;
+
+	w.stats.crossover += t1 - t0;
+	w.stats.mutation += t2 - t1;
+	w.stats.evaluation += now() - t2;
+}
+
+/*
+ * local search is deterministic, so it needs no random stream. Moves it
+ * tries and undoes clear the fitness too, which is cached anyway.
+ */
+void geneticAlgorithm::improveOffspring(struct worker &w, int i)
+{
+	Individual &ind = offspring->getIndividual(improving[i]);
+	uint64_t t0 = now();
+
+	w.calc.improve(ind);
+	ind.setFitness(w.calc.getFitness(ind));
+	w.stats.evaluations++;
+	w.stats.localSearch += now() - t0;
+}
+
+/*
+ * generatePopulation: the first valid candidates, in candidate order.
+ * Past the seeded ones, a round without a single valid candidate ends
+ * the search: random candidates that repair cannot fix rarely get
+ * better, and the population evolves as large as it got.
+ * @complexity: O(maxtries x validity test / nthreads)
+ */
+void geneticAlgorithm::generatePopulation(Population &pop, int maxtries)
+{
+	int i, n, found, filled = 0;
+
+	candidates.resize(CANDIDATES_PER_ROUND);
+	candidateValid.resize(CANDIDATES_PER_ROUND);
+	seeds.resize(SEED_HEURISTICS);
+	for (i = 0; i < SEED_HEURISTICS; i++)
+		workers[0].calc.seedIndividual(seeds[i], (seedHeuristic)i);
+	seeded = max(pop.getSize() / 2, (int)SEED_HEURISTICS);
+
+	while (filled < pop.getSize() && maxtries > 0) {
+		n = maxtries < CANDIDATES_PER_ROUND ? maxtries : CANDIDATES_PER_ROUND;
+		runRound(CANDIDATES, 0, n);
+
+		for (i = found = 0; i < n; i++) {
+			if (!candidateValid[i])
+				continue;
+			found++;
+			if (filled < pop.getSize())
+				pop.getIndividual(filled++).swap(candidates[i]);
+		}
+		candidate += n;
+		maxtries -= n;
+		if (!found && candidate >= (unsigned long)seeded)
+			break;
+	}
+	pop.resize(filled);
+	for (i = 0; i < (int)workers.size(); i++) {
+		evaluations += workers[i].stats.evaluations;
+		workers[i].stats.evaluations = 0;
+	}
 }
 
-Population geneticAlgorithm::evolvePopulation(Population pop)
+/* orders individuals by decreasing fitness, then by index */
+struct fitter {
+	Population &pop;
+
+	fitter(Population &pop)
+		:pop(pop)
+	{
+	}
+	bool operator()(int a, int b) const
+	{
+		double fa = pop.getIndividual(a).getFitness();
+		double fb = pop.getIndividual(b).getFitness();
+
+		return fa > fb || (fa == fb && a < b);
+	}
+};
+
+void geneticAlgorithm::evolvePopulation(Population &pop, Population &next)
 {
-	Population newPopulation(pop.getSize(), false);
-	int i, elitismOffset;
+	int i, n, elitismOffset;
+	uint64_t t0;
+
+	/* cache counters run over the whole run, hits and misses are differences */
+	memset(&stats, 0, sizeof(stats));
+	for (i = 0; i < (int)workers.size(); i++) {
+		workers[i].stats = stats;
+		stats.hits -= workers[i].calc.getCacheHits();
+		stats.misses -= workers[i].calc.getCacheMisses();
+	}
 
 	if (elitism)
-		newPopulation.setIndividual(0, pop.getFittest());
+		next.setIndividual(0, pop.getFittest());
 
 	// crossover population
 	if (elitism)
@@ -28,101 +297,168 @@ Population geneticAlgorithm::evolvePopulation(Population pop)
 	else
 		elitismOffset = 0;
 
-	// Creating individuals with crossover
+	// Selecting the parents of every offspring, in order
+	t0 = now();
+	mates.resize(2 * pop.getSize());
 	for (i = elitismOffset; i < pop.getSize(); i++) {
-		Individual indiv1 = tournamentSelection(pop);
-		Individual indiv2 = tournamentSelection(pop);
-		Individual newIndiv = crossover(indiv1, indiv2);
-
-		newPopulation.setIndividual(i, newIndiv);
+		mates[2 * i] = tournamentSelection(pop);
+		mates[2 * i + 1] = tournamentSelection(pop);
 	}
+	stats.selection = now() - t0;
 
-	// mutate population
-	for (i = elitismOffset; i < newPopulation.getSize(); i++) {
-		Individual ind = newPopulation.getIndividual(i);
-
-		mutate(&ind);
+	// Creating, mutating and evaluating individuals on the workers
+	parents = &pop;
+	offspring = &next;
+	runRound(OFFSPRING, elitismOffset, pop.getSize() - elitismOffset);
 
-		newPopulation.setIndividual(i, ind);
-	}
+	// Improving the fittest offspring, ties broken by index
+	improving.clear();
+	for (i = elitismOffset; i < next.getSize(); i++)
+		improving.push_back(i);
+	n = min(localSearch, (int)improving.size());
+	partial_sort(improving.begin(), improving.begin() + n, improving.end(),
+			fitter(next));
+	improving.resize(n);
+	runRound(IMPROVE, 0, n);
+	generation++;
 
-	return newPopulation;
+	collectStats(next);
 }
 
-Individual geneticAlgorithm::crossover(Individual indiv1, Individual indiv2)
+/*
+ * collectStats: sums what the workers counted in the last generation and
+ * takes the energies of next
+ * @complexity: O(population + nthreads)
+ */
+void geneticAlgorithm::collectStats(Population &next)
 {
-	Individual newSol(indiv1.getSize());
-	int nTasks = fitnessCalcPGA::getNTasks();
-	bool valid = false;
-	int found;
-	int j;
+	int i;
 
-	found = 0;
+	for (i = 0; i < (int)workers.size(); i++) {
+		struct generationStats &w = workers[i].stats;
 
-	// Pivoting
-	while (found < nTasks && !valid) {
-		// get lower tasks from Indiv1
-		for (j = 0; j < found; j++) {
-			int gene;
+		stats.valid += w.valid;
+		stats.evaluations += w.evaluations;
+		stats.crossover += w.crossover;
+		stats.mutation += w.mutation;
+		stats.evaluation += w.evaluation;
+		stats.localSearch += w.localSearch;
+		stats.hits += workers[i].calc.getCacheHits();
+		stats.misses += workers[i].calc.getCacheMisses();
+	}
+	evaluations += stats.evaluations;
 
-			gene = fitnessCalcPGA::getTaskGene(j, indiv1);	
-			newSol.setGene(gene, 1);
+	/* fitness is the inverse of energy */
+	for (i = 0; i < next.getSize(); i++) {
+		double e = 1.0 / next.getIndividual(i).getFitness();
 
-		}
-		// get upper tasks from Indiv2
-		for (j = found; j < nTasks; j++) {
-			int gene;
+		if (i == 0 || e < stats.best)
+			stats.best = e;
+		if (i == 0 || e > stats.worst)
+			stats.worst = e;
+		stats.mean += e / next.getSize();
+	}
+}
 
-			gene = fitnessCalcPGA::getTaskGene(j, indiv2);	
-			newSol.setGene(gene, 1);
+/*
+ * crossover: each task takes its gene from indiv1 with probability
+ * uniformRate and from indiv2 otherwise, and the child is repaired into a
+ * valid one. When it cannot be, the child is the parent of lower energy.
+ * @complexity: O(nTasks) and one repair
+ */
+bool geneticAlgorithm::crossover(fitnessCalcPGA &calc,
+				const Individual &indiv1,
+				const Individual &indiv2, Individual &child,
+				RandomStream &stream)
+{
+	int nTasks = calc.getNTasks();
+	double fo1, fo2;
+	int j;
 
-		}
-		valid = fitnessCalcPGA::isIndividualValid(newSol);
-		found++; 
-	}
+	child.reset(nTasks);
+	for (j = 0; j < nTasks; j++)
+		child.copyGene(j, stream.real() < uniformRate ? indiv1 : indiv2);
 
-	if (!valid) {
-		double fo1, fo2;
+	if (calc.repair(child))
+		return true;
 
-		fo1 = fitnessCalcPGA::getFOPower(indiv1);
-		fo2 = fitnessCalcPGA::getFOPower(indiv2);
-		if (fo1 > fo2)
-			newSol = fo2;
-		else
-			newSol = fo1;
-	}
+	fo1 = calc.getFOPower(indiv1);
+	fo2 = calc.getFOPower(indiv2);
+	if (fo1 > fo2)
+		child = indiv2;
+	else
+		child = indiv1;
 
-	return newSol;
+	return false;
 }
 
-void geneticAlgorithm::mutate(Individual *indiv)
+void geneticAlgorithm::perturb(fitnessCalcPGA &calc, Individual &indiv,
+				RandomStream &stream)
 {
-	int nAgents= fitnessCalcPGA::getNAgents();
-	int nTasks = fitnessCalcPGA::getNTasks();
-	int nLevels = fitnessCalcPGA::getNLevels();
+	int nTasks = calc.getNTasks();
+	int n = nTasks / 10 > 1 ? nTasks / 10 : 1;
+
+	while (n-- > 0)
+		indiv.setGene((int)(stream.real() * nTasks),
+				(int)(stream.real() * calc.getNAgents()),
+				(int)(stream.real() * calc.getNLevels()));
+}
+
+bool geneticAlgorithm::mutate(fitnessCalcPGA &calc, Individual &indiv,
+				RandomStream &stream)
+{
+	bool changed = false;
+	int nAgents= calc.getNAgents();
+	int nTasks = calc.getNTasks();
+	int nLevels = calc.getNLevels();
 	int j;
 
 	for (j = 0; j < nTasks; j++) {
-		if (((double)random() / (RAND_MAX)) <= mutationRate) {
-			int a  = (int)drand48() * nAgents;
-			int l  = (int)drand48() * nLevels;
-			indiv->setGene(fitnessCalcPGA::getTaskGene(j, *indiv), 0);
-			indiv->setGene(a * (nTasks * nLevels) + j * nLevels + l, 1);
+		if (stream.real() < mutationRate) {
+			int a  = (int)(stream.real() * nAgents);
+			int l  = (int)(stream.real() * nLevels);
+			indiv.setGene(j, a, l);
+			changed = true;
 		}
 	}
 
+	return changed;
 }
 
-Individual geneticAlgorithm::tournamentSelection(Population pop)
+int geneticAlgorithm::tournamentSelection(Population &pop)
 {
-	Population tournament(tournamentSize, false);
+	int fittest = -1;
 	int i;
 
 	for (i = 0; i < tournamentSize; i++) {
-		int randomomId = (int) (((double)random() / (RAND_MAX)) * (double) pop.getSize());
+		int randomomId = (int)(selection.real() * pop.getSize());
 
-		tournament.setIndividual(i, pop.getIndividual(randomomId));
+		if (fittest < 0 || pop.getIndividual(fittest).getFitness() <=
+				pop.getIndividual(randomomId).getFitness())
+			fittest = randomomId;
 	}
 
-	return tournament.getFittest();
+	return fittest;
+}
+
+unsigned long geneticAlgorithm::getCacheHits(void) const
+{
+	unsigned long hits = 0;
+	unsigned int i;
+
+	for (i = 0; i < workers.size(); i++)
+		hits += workers[i].calc.getCacheHits();
+
+	return hits;
+}
+
+unsigned long geneticAlgorithm::getCacheMisses(void) const
+{
+	unsigned long misses = 0;
+	unsigned int i;
+
+	for (i = 0; i < workers.size(); i++)
+		misses += workers[i].calc.getCacheMisses();
+
+	return misses;
 }
@@ -1,20 +1,134 @@
 #ifndef __GENETIC_ALGORITHM_H
 #define __GENETIC_ALGORITHM_H
 
+#include <stdint.h>
+#include <pthread.h>
+#include <vector>
+#include <statistics.h>
+#include "fitnesscalcPGA.h"
 #include "individuals.h"
+#include "population.h"
 
+/*
+ * What the last generation cost: energies of the offspring population,
+ * crossover children repaired rather than replaced by a parent, fitness
+ * cache use and nanoseconds per phase, summed over the workers.
+ */
+struct generationStats {
+	double best, mean, worst;
+	int valid;
+	unsigned long hits, misses;
+	unsigned long evaluations;	/* individuals evaluated */
+	uint64_t selection, crossover, mutation, evaluation, localSearch;
+};
+
+/*
+ * Operators work in place: parents are referenced by index into the
+ * current population and offspring are written over the next one.
+ *
+ * Parents are selected on the calling thread; breeding and evaluating
+ * the offspring, improving the fittest of them by local search, and
+ * generating the initial candidates, run on nthreads workers, each with
+ * its own fitness calculator. The calling thread is the first worker, the
+ * others are threads that live as long as the algorithm and wait for each
+ * round on a condition variable. Every candidate and
+ * every offspring draws from its own random stream, derived from the
+ * seed and its index, so a seed gives the same run whatever the thread
+ * count.
+ */
 class geneticAlgorithm {
 	private:
+		enum roundKind { CANDIDATES, OFFSPRING, IMPROVE };
+
+		struct worker {
+			geneticAlgorithm *ga;
+			fitnessCalcPGA calc;
+			Individual mutant;	/* scratch of breedOffspring */
+			struct generationStats stats;	/* of its jobs */
+			pthread_t thread;
+		};
+
 		double uniformRate;
 		double mutationRate;
 		int tournamentSize;
+		int localSearch;		/* offspring improved per generation */
 		bool elitism;
+		uint64_t seed;
+		RandomStream selection;
+		unsigned long generation;
+		unsigned long candidate;	/* candidates generated so far */
+		std::vector <struct worker> workers;
+
+		/* the round being run, handed out under lock */
+		pthread_mutex_t lock;
+		pthread_cond_t start;
+		pthread_cond_t done;
+		unsigned long round;		/* bumped for each round */
+		int pending;			/* worker threads still in it */
+		bool quit;
+		roundKind kind;
+		int first, count;
+		int next;			/* next job of the round to run */
+		Population *parents, *offspring;
+		std::vector <int> mates;	/* two parents per offspring */
+		std::vector <int> improving;	/* offspring to improve */
+		std::vector <Individual> candidates;
+		std::vector <char> candidateValid;
+		std::vector <Individual> seeds;	/* one per seedHeuristic */
+		int seeded;			/* candidates built from seeds */
+		struct generationStats stats;	/* of the last generation */
+		unsigned long evaluations;	/* over the whole run */
+
+		static void *run(void *data);
+		void runJobs(struct worker &w);
+		void runRound(roundKind kind, int first, int count);
+		void generateCandidate(struct worker &w, int i);
+		void breedOffspring(struct worker &w, int i);
+		void improveOffspring(struct worker &w, int i);
+		void collectStats(Population &next);
+
+		geneticAlgorithm(const geneticAlgorithm &);
+		geneticAlgorithm &operator=(const geneticAlgorithm &);
 	public:
-		geneticAlgorithm(void);
-		Population evolvePopulation(Population pop);
-		Individual crossover(Individual indiv1, Individual indiv2);
-		void mutate(Individual *indiv);
-		Individual tournamentSelection(Population pop);
+		/* calc holds the model, nthreads <= 0 for one per core */
+		geneticAlgorithm(const fitnessCalcPGA &calc, int nthreads,
+				uint64_t seed);
+		~geneticAlgorithm();
+		void setMutationRate(double rate)
+		{
+			mutationRate = rate;
+		}
+		/*
+		 * fills pop with valid individuals out of maxtries candidates:
+		 * the heuristic seeds, then perturbations of them up to half of
+		 * pop, then random ones while they bring valid ones, all of
+		 * them repaired
+		 */
+		void generatePopulation(Population &pop, int maxtries);
+		/* fills next, as large as pop, with the offspring of pop */
+		void evolvePopulation(Population &pop, Population &next);
+		/* false when the child is a copy of a parent */
+		bool crossover(fitnessCalcPGA &calc, const Individual &indiv1,
+				const Individual &indiv2, Individual &child,
+				RandomStream &stream);
+		/* moves a tenth of the tasks, at least one, anywhere */
+		void perturb(fitnessCalcPGA &calc, Individual &indiv,
+				RandomStream &stream);
+		/* true when a gene changed */
+		bool mutate(fitnessCalcPGA &calc, Individual &indiv,
+				RandomStream &stream);
+		int tournamentSelection(Population &pop);
+		const struct generationStats &getStats(void) const
+		{
+			return stats;
+		}
+		/* candidates and offspring evaluated so far */
+		unsigned long getEvaluations(void) const
+		{
+			return evaluations;
+		}
+		unsigned long getCacheHits(void) const;
+		unsigned long getCacheMisses(void) const;
 };
 
 #endif
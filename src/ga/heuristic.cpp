@@ -0,0 +1,120 @@
+/*
+ * src/ga/heuristic.cpp
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <heuristic.h>
+#include "fitnesscalcPGA.h"
+#include "individuals.h"
+
+#define HEURISTIC_CANDIDATES	100	/* random ones, after the seeds */
+
+/*
+ * heuristicStart: the seeds, which come repaired and improved, then
+ * random candidates, each repaired and the valid ones improved. The
+ * cheapest is kept. The candidates come from a fixed stream, so a model always
+ * gets the same start.
+ * @complexity: O(SEED_HEURISTICS + HEURISTIC_CANDIDATES) repairs and
+ * local searches
+ */
+bool heuristicStart(const mgapModel &model, fitnessTest test,
+			NumArray3 &start, double &energy)
+{
+	fitnessCalcPGA calc;
+	RandomStream stream;
+	Individual ind, best;
+	bool found = false;
+	int n, i, j;
+
+	calc.setTest(test);
+	calc.setModel(model);
+	for (n = 0; n < SEED_HEURISTICS + HEURISTIC_CANDIDATES; n++) {
+		double e;
+
+		if (n < SEED_HEURISTICS) {
+			calc.seedIndividual(ind, (seedHeuristic)n);
+		} else {
+			calc.fitIndividual(ind, stream);
+			if (calc.repair(ind))
+				calc.improve(ind);
+		}
+		if (!calc.isIndividualValid(ind))
+			continue;
+		e = calc.getFOPower(ind);
+		if (!found || e < energy) {
+			best = ind;
+			energy = e;
+			found = true;
+		}
+	}
+	if (!found)
+		return false;
+
+	start.assign(calc.getNAgents(), NumArray2(calc.getNTasks(),
+				NumArray(calc.getNLevels(), 0.0)));
+	for (j = 0; j < calc.getNTasks(); j++) {
+		i = best.getAgent(j);
+		start[i][j][best.getLevel(j)] = 1.0;
+	}
+
+	return true;
+}
+
+RelaxationRounding::RelaxationRounding(const mgapModel &model,
+					fitnessTest test)
+	:calc(new fitnessCalcPGA()), ind(new Individual()),
+	nAgents(model.cycles.size()), nTasks(model.period.size()),
+	nLevels(model.frequency[0].size())
+{
+	calc->setTest(test);
+	calc->setModel(model);
+}
+
+RelaxationRounding::~RelaxationRounding()
+{
+	delete calc;
+	delete ind;
+}
+
+/*
+ * round: each task to the agent and level of its largest value, ties to
+ * the first, then repaired and improved as the GA offspring are.
+ * @complexity: O(agents x tasks x levels) plus a repair and a local search
+ */
+bool RelaxationRounding::round(const NumArray &relaxation, NumArray &solution,
+				double &energy)
+{
+	int i, j, k, c;
+
+	ind->reset(nTasks);
+	for (j = 0; j < nTasks; j++) {
+		int best = -1;
+
+		for (i = 0; i < nAgents; i++)
+			for (k = 0; k < nLevels; k++) {
+				c = (i * nTasks + j) * nLevels + k;
+				if (best < 0 || relaxation[c] > relaxation[best])
+					best = c;
+			}
+		ind->setGene(j, best / nLevels / nTasks, best % nLevels);
+	}
+
+	if (!calc->repair(*ind))
+		return false;
+	calc->improve(*ind);
+	if (!calc->isIndividualValid(*ind))
+		return false;
+	energy = calc->getFOPower(*ind);
+
+	solution.assign(nAgents * nTasks * nLevels, 0.0);
+	for (j = 0; j < nTasks; j++)
+		solution[(ind->getAgent(j) * nTasks + j) * nLevels +
+			ind->getLevel(j)] = 1.0;
+
+	return true;
+}
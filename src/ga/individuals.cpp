@@ -1,73 +1,48 @@
 #include <iostream>
+#include <sstream>
 #include <stdlib.h>
 #include "individuals.h"
-#include "fitnesscalcPGA.h"
 
 using namespace std;
 
-int Individual::defaultGeneLength = 1000;
-
-Individual::Individual(void) : genes(defaultGeneLength)
+Individual::Individual(void)
 {
-	int i;
-
 	fitness = 0.0;
-	for (i = 0; i < genes.size(); i++)
-		genes[i] = 0;
 }
 
-Individual::Individual(int size) : genes(size)
+Individual::Individual(int ntasks)
 {
-	int i;
-
-	fitness = 0.0;
-	for (i = 0; i < genes.size(); i++)
-		genes[i] = 0;
+	reset(ntasks);
 }
 
-void Individual::generateIndividual(void)
+void Individual::reset(int ntasks)
 {
-	fitnessCalcPGA::fitIndividual(this);
-}
+	struct gene unassigned = { -1, 0 };
 
-byte Individual::getGene(int index)
-{
-	return genes[index];
-}
-
-void Individual::setGene(int index, byte gene)
-{
-	genes[index] = !!gene;
+	genes.assign(ntasks, unassigned);
 	fitness = 0.0;
 }
 
-int Individual::getSize(void)
+/* agent:level per task, - when unassigned */
+string Individual::toString(void) const
 {
-	return genes.size();
-}
+	ostringstream genestring;
+	int j;
 
-void Individual::setSize(int size)
-{
-	return genes.resize(size);
-}
-
-double Individual::getFitness(void)
-{
-	if (fitness >= 0.0 && fitness <= 0.0)
-		fitness = fitnessCalcPGA::getFitness(*this);
+	for (j = 0; j < getSize(); j++) {
+		if (j)
+			genestring << " ";
+		if (isAssigned(j))
+			genestring << getAgent(j) << ":" << getLevel(j);
+		else
+			genestring << "-";
+	}
 
-	return fitness;
+	return genestring.str();
 }
 
-string Individual::toString(void)
+void Individual::swap(Individual &other)
 {
-	string genestring = "";
-	int i;
-
-	for (i = 0; i < getSize(); i++) {
-		char b = '0' + getGene(i);
-		genestring += b;
-	}
-
-	return genestring;
+	genes.swap(other.genes);
+	std::swap(fitness, other.fitness);
 }
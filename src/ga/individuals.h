@@ -7,22 +7,65 @@ typedef unsigned char byte;
 
 using namespace std;
 
+/*
+ * One gene per task: the agent it runs on and the level it runs at, so a
+ * task is assigned at most once by construction. Individuals are reused
+ * in place across generations: reset() and assignment keep the gene
+ * storage, so a run allocates it only once.
+ */
 class Individual {
 	private:
-		static int defaultGeneLength;
+		struct gene {
+			short agent;	/* -1 while the task is unassigned */
+			short level;
+		};
 
-		vector <byte> genes;
-		double fitness;
+		vector <struct gene> genes;
+		double fitness;		/* 0 until set */
 	public:
 		Individual(void);
-		Individual(int size);
-		void generateIndividual(void);
-		byte getGene(int index);
-		void setGene(int index, byte gene);
-		int getSize(void);
-		void setSize(int size);
-		double getFitness(void);
-		string toString(void);
+		Individual(int ntasks);
+		/* ntasks genes, none assigned */
+		void reset(int ntasks);
+		int getAgent(int task) const
+		{
+			return genes[task].agent;
+		}
+		int getLevel(int task) const
+		{
+			return genes[task].level;
+		}
+		bool isAssigned(int task) const
+		{
+			return genes[task].agent >= 0;
+		}
+		void setGene(int task, int agent, int level)
+		{
+			genes[task].agent = agent;
+			genes[task].level = level;
+			fitness = 0.0;
+		}
+		/* copies the gene of task from other */
+		void copyGene(int task, const Individual &other)
+		{
+			genes[task] = other.genes[task];
+			fitness = 0.0;
+		}
+		int getSize(void) const
+		{
+			return genes.size();
+		}
+		/* as computed by the fitness calculator */
+		double getFitness(void) const
+		{
+			return fitness;
+		}
+		void setFitness(double f)
+		{
+			fitness = f;
+		}
+		string toString(void) const;
+		void swap(Individual &other);
 };
 
 #endif
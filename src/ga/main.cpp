@@ -1,95 +1,125 @@
-#include <sys/time.h>
-#include <math.h>
-#include <float.h>
 #include <stdlib.h>
 #include <iostream>
-#include <getopt.h>
-#include <errno.h>
-#include "fitnesscalcPGA.h"
-#include "population.h"
-#include "individuals.h"
-#include "geneticalgorithm.h"
+#include <fstream>
+#include <corpus.h>
+#include <solver.h>
 
 using namespace std;
 
-static long get_execution_time(struct timeval s, struct timeval e)
+#ifndef SOLVER_NAME
+#error "SOLVER_NAME must name the registered genetic solver to run"
+#endif
+
+/*
+ * Solves every model of corpus on the same solver, one line per model:
+ * index, feasibility, time, energy and gap.
+ */
+static int solve_batch(Solver *solver, const char *filename,
+			const solverLimits &limits)
 {
-	struct timeval diff;
+	Corpus corpus;
+	mgapModel model;
+	solverResult result;
+	int i, ret = 0;
+
+	if (!corpus.open(filename)) {
+		cerr << "ERROR: could not open corpus '" << filename << "'" << endl;
+		return 1;
+	}
 
-	timersub(&e, &s, &diff);
+	for (i = 0; i < corpus.size(); i++) {
+		result = solverResult();
+		if (!corpus.get(i, model) || !solver->solve(model, limits, result)) {
+			cout << i << " error" << endl;
+			ret = 1;
+			continue;
+		}
+		cout << i << " " << result.good << " " << result.etimes << " "
+			<< result.energy << " " << result.gap << endl;
+	}
 
-	return diff.tv_sec * 1000000 + diff.tv_usec;
+	return ret;
 }
 
 int main(int argc, char *argv[])
 {
-	struct timeval st, e;
 	const char *filename = "facility.dat";
-	long etimes;
-	double f = -1.0;
-	int iteration = 100;
-	int popSize = 50;
-	int equals = 0, max_equals;
-	int generationCount = 0;
+	mgapModel model;
+	solverLimits limits;
+	solverResult result;
+	Solver *solver;
+	int index = -1, ret;
+
+	limits.iterations = 100;
 
 	if (argc > 1)
 		filename = argv[1];
 
 	if (argc > 2)
-		iteration = atoi(argv[2]);
+		limits.iterations = atoi(argv[2]);
 
 	if (argc > 3)  {
 		srandom(atoi(argv[3]));
 		cout << "Seeded with " << atoi(argv[3]) << endl;
 	}
 
-	max_equals = iteration / 10;
-	geneticAlgorithm Algorithm;
+	/* model to solve when filename is a corpus, all of them if none */
+	if (argc > 4)
+		index = atoi(argv[4]);
 
-	fitnessCalcPGA::feedModel(filename);
+	/* worker threads, one per core if not given */
+	if (argc > 5)
+		limits.threads = atoi(argv[5]);
 
-	gettimeofday(&st, NULL);
-	// Create an initial population
-	Population myPop(popSize, true);
+	/* sub-populations, and generations between their migrations */
+	if (argc > 6)
+		limits.islands = atoi(argv[6]);
 
-	if (myPop.getSize() == 0) {
-		cout << "Could not generate valid individuals" << endl;
-		exit(1);
-	}
+	if (argc > 7)
+		limits.migration = atoi(argv[7]);
+
+	/* one line per generation and island, see README */
+	if (argc > 8)
+		limits.trace = argv[8];
 
-	if (myPop.getSize() == popSize) {
+	solver = createSolver(SOLVER_NAME);
+	if (!solver)
+		exit(1);
 
-		// Evolve our population until we reach an optimum solution
+	if (Corpus::isCorpus(filename)) {
+		Corpus corpus;
 
-		while (generationCount++ < iteration && equals != max_equals) {
-			double l = myPop.getFittest().getFitness(); 
+		if (index < 0) {
+			ret = solve_batch(solver, filename, limits);
+			delete solver;
+			return ret;
+		}
 
-			 	//cout << "Generation: " << generationCount << " Fittest: " << l << endl; 
-			if (fabs(l - f) <= DBL_EPSILON) {
-				equals++;
-			} else {
-				f = l;
-				equals = 0;
-			}
-			myPop = Algorithm.evolvePopulation(myPop);
+		if (!corpus.open(filename) || !corpus.get(index, model)) {
+			cerr << "ERROR: could not read model " << index
+				<< " from corpus '" << filename << "'" << endl;
+			exit(1);
 		}
-	}
-	gettimeofday(&e, NULL);
-	etimes = get_execution_time(st, e);
-	if (fitnessCalcPGA::isIndividualValid(myPop.getFittest())) {
-		cout << 1 << endl;
-		cout << etimes << endl;
-		cout << fitnessCalcPGA::getFOPower(myPop.getFittest()) << endl;
-		cout << 0 << endl;
-		cout << "Generation: " << generationCount << endl;
-		fitnessCalcPGA::dumpConfigurationInfo(myPop.getFittest());
 	} else {
-		cout << 0 << endl;
-		cout << 0 << endl;
-		cout << 0 << endl;
-		cout << 0 << endl;
-		cout << "Solution found is not feasible" << endl;
+		ifstream file(filename);
+
+		if (!file) {
+			cerr << "ERROR: could not open file '" << filename
+				<< "' for reading" << endl;
+			exit(1);
+		}
+		readModel(file, model);
 	}
 
+	if (!solver->solve(model, limits, result))
+		exit(1);
+
+	cout << result.good << endl;
+	cout << result.etimes << endl;
+	cout << result.energy << endl;
+	cout << result.gap << endl;
+	solver->dumpSolution();
+	delete solver;
+
 	return 0;
 }
@@ -1,62 +1,41 @@
 #include <iostream>
-#include "fitnesscalcPGA.h"
 #include "population.h"
 #include "individuals.h"
 
 using namespace std;
 
-Population::Population(int populationSize, bool initialise) : individuals(populationSize)
+Population::Population(int populationSize) : individuals(populationSize)
 {
-	if (!initialise)
-		return;
-
-	generatePopulation(populationSize, populationSize*1000);
-}
-
-void Population::generatePopulation(int populationSize, int maxtries)
-{
-	int i;
-
-	individuals.clear();
-	i = 0;
-	do {
-		Individual ind;
-
-		ind.generateIndividual();
-		if (fitnessCalcPGA::isIndividualValid(ind)) {
-			individuals.push_back(ind);
-			i++;
-		}
-	} while (--maxtries > 0 && i < populationSize);
 }
 
 /* Getters */
-Individual Population::getIndividual(int index)
-{
-	return individuals[index];
-}
-
-void Population::setIndividual(int index, Individual indiv)
+void Population::setIndividual(int index, const Individual &indiv)
 {
 	individuals[index] = indiv;
 }
 
-Individual Population::getFittest(void)
+int Population::getFittestIndex(void)
 {
-	Individual fittest = individuals[0];
+	int fittest = 0;
 	int i;
 
 	for (i = 0; i < getSize(); i++) {
-		Individual k = getIndividual(i);
-		if (fittest.getFitness() <= k.getFitness()) {
-			fittest = k;
-		}
+		if (individuals[fittest].getFitness() <= individuals[i].getFitness())
+			fittest = i;
 	}
 
 	return fittest;
 }
 
-int Population::getSize(void)
+int Population::getLeastFitIndex(void)
 {
-	return individuals.size();
+	int least = 0;
+	int i;
+
+	for (i = 0; i < getSize(); i++) {
+		if (individuals[least].getFitness() > individuals[i].getFitness())
+			least = i;
+	}
+
+	return least;
 }
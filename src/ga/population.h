@@ -8,13 +8,32 @@ class Population {
 	private:
 		std::vector<Individual> individuals;
 	public:
-		Population(int polulationSize, bool initialise);
-		void generatePopulation(int polulationSize, int maxtries);
+		Population(int populationSize);
+		void resize(int populationSize)
+		{
+			individuals.resize(populationSize);
+		}
 		/* Getters */
-		Individual getIndividual(int index);
-		void setIndividual(int index, Individual indiv);
-		Individual getFittest(void);
-		int getSize(void);
+		Individual &getIndividual(int index)
+		{
+			return individuals[index];
+		}
+		void setIndividual(int index, const Individual &indiv);
+		int getFittestIndex(void);
+		int getLeastFitIndex(void);
+		Individual &getFittest(void)
+		{
+			return individuals[getFittestIndex()];
+		}
+		int getSize(void) const
+		{
+			return individuals.size();
+		}
+		/* O(1), generations are double buffered */
+		void swap(Population &other)
+		{
+			individuals.swap(other.individuals);
+		}
 };
 
 #endif
@@ -0,0 +1,164 @@
+/*
+ * src/hydra_corpus.cpp
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+/*
+ * Converts text models, as written by hydra_gen, into a binary corpus
+ * and dumps corpus models back as text.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <getopt.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iostream>
+
+#include <corpus.h>
+#include <coefficients.h>
+
+static const char *short_options = "ho:d:n:c";
+static const struct option long_options[] = {
+	{ "help",     0, NULL, 'h' },
+	{ "output",  required_argument, NULL, 'o' },
+	{ "dump",  required_argument, NULL, 'd' },
+	{ "model-index",  required_argument, NULL, 'n' },
+	{ "coefficients",  0, NULL, 'c' },
+	{ NULL,       0, NULL, 0   },   /* Required at end of array.  */
+};
+
+static void print_usage(char *program_name)
+{
+	printf("Usage: %s  options [model files]\n", program_name);
+	printf(
+	"  -h  --help                             Display this usage information.\n"
+	"  -o  --output=<corpus>                  Write the given text model files into corpus.\n"
+	"  -d  --dump=<corpus>                    Print the models of corpus as text.\n"
+	"  -n  --model-index=<index>              Only dump the model at index.\n"
+	"  -c  --coefficients                     Dump the cost tensors after each model.\n");
+}
+
+static int convert(const char *output, int nfiles, char **files)
+{
+	CorpusWriter writer;
+	int i;
+
+	if (!writer.open(output)) {
+		cerr << "ERROR: could not open file '" << output
+			<< "' for writing" << endl;
+		return -EINVAL;
+	}
+
+	for (i = 0; i < nfiles; i++) {
+		ifstream file(files[i]);
+		mgapModel model;
+
+		if (!file) {
+			cerr << "ERROR: could not open file '" << files[i]
+				<< "' for reading" << endl;
+			break;
+		}
+		if (!readModel(file, model) || !writer.add(model)) {
+			cerr << "ERROR: could not convert model file '"
+				<< files[i] << "'" << endl;
+			break;
+		}
+	}
+
+	/* no partial corpus is left behind */
+	if (i < nfiles) {
+		writer.close();
+		unlink(output);
+		return -EINVAL;
+	}
+
+	if (!writer.close()) {
+		cerr << "ERROR: could not write file '" << output << "'" << endl;
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static int dump(const char *input, int index, bool coefficients)
+{
+	Corpus corpus;
+	mgapModel model;
+	mgapCoefficients coef;
+	int i;
+
+	if (!corpus.open(input)) {
+		cerr << "ERROR: '" << input << "' is not a model corpus" << endl;
+		return -EINVAL;
+	}
+
+	for (i = 0; i < corpus.size(); i++) {
+		if (index >= 0 && i != index)
+			continue;
+		if (!corpus.get(i, model)) {
+			cerr << "ERROR: model " << i << " of '" << input
+				<< "' is corrupted" << endl;
+			return -EINVAL;
+		}
+		writeModel(cout, model);
+		if (coefficients) {
+			coef.compute(model);
+			writeCoefficients(cout, coef);
+		}
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *output = NULL, *input = NULL;
+	int next_option;
+	int index = -1;
+	bool coefficients = false;
+
+	/* Read command line options */
+	do {
+		next_option = getopt_long (argc, argv, short_options,
+						long_options, NULL);
+		switch (next_option) {
+		default:    /* Something else: unexpected.  */
+		case '?':   /* The user specified an invalid option.  */
+		case 'h':   /* -h or --help */
+			print_usage(argv[0]);
+			return 0;
+		case 'o':   /* -o or --output */
+			output = optarg;
+			break;
+		case 'd':   /* -d or --dump */
+			input = optarg;
+			break;
+		case 'n':   /* -n or --model-index */
+			index = strtol(optarg, NULL, 10);
+			break;
+		case 'c':   /* -c or --coefficients */
+			coefficients = true;
+			break;
+		case -1:    /* Done with options.  */
+			break;
+		}
+	} while (next_option != -1);
+
+	if (input)
+		return dump(input, index, coefficients);
+
+	if (!output || optind >= argc) {
+		print_usage(argv[0]);
+		return -EINVAL;
+	}
+
+	return convert(output, argc - optind, argv + optind);
+}
@@ -18,15 +18,14 @@
 #include <getopt.h>
 #include <signal.h>
 
-#include <akaroa.H>
-#include <akaroa/distributions.H>
-
-#include <analysis.h>
-#include <gcd_hash.h>
+#include <akaroa_compat.h>
 
 #include <ilcplex/ilocplex.h>
 ILOSTLBEGIN
 
+#include <analysis_concert.h>
+#include <corpus.h>
+
 static double wcec_min = 100, wcec_max = 200;
 static double deadline_min = 10, deadline_max = 50;
 static double period_min = 10, period_max = 50;
@@ -59,7 +58,7 @@ static double inline next_ak(double min, double max)
 	return Uniform(min, max);
 }
 
-static const char *short_options = "hvpa:u:f:s:r:n:l:m:c:g:o:";
+static const char *short_options = "hvpa:u:f:s:r:n:l:m:c:g:o:b:";
 static const struct option long_options[] = {
 	{ "help",     0, NULL, 'h' },
 	{ "verbose",  0, NULL, 'v' },
@@ -72,6 +71,7 @@ static const struct option long_options[] = {
 	{ "task-count",  required_argument, NULL, 'n' },
 	{ "model-count",  required_argument, NULL, 'g' },
 	{ "output-location",  required_argument, NULL, 'o' },
+	{ "corpus",  required_argument, NULL, 'b' },
 	{ "switch-latency",  required_argument, NULL, 'l' },
 	{ "processor-count",  required_argument, NULL, 'm' },
 	{ "compare-no-lp",  0, NULL, 'c' },
@@ -92,6 +92,7 @@ static void print_usage(char *program_name)
 	"  -n  --task-count=<task-count>          Number of tasks to be generated per task model.\n"
 	"  -g  --model-count=<model-count>        Number of models to be generated.\n"
 	"  -o  --output-location=<dir>            Directory to output the generated models.\n"
+	"  -b  --corpus=<file-name>               Write all generated models into one binary corpus.\n"
 	"  -l  --switch-latency=<Lp>              Switching Latency.\n"
 	"  -m  --processor-count=<freq-count>     Number of processors per cluster.\n");
 }
@@ -324,6 +325,22 @@ void write_model(struct thread_data *tdata, string location)
 	mfile.close();
 }
 
+/* appends the model to the corpus instead of writing a file per model */
+static int write_corpus_model(struct thread_data *tdata, CorpusWriter &corpus)
+{
+	mgapModel model;
+
+	model.alpha = 1;
+	fromConcert(*(tdata->priority), model.priority);
+	fromConcert(*(tdata->period), model.period);
+	fromConcert(*(tdata->deadline), model.deadline);
+	fromConcert(*(tdata->cycles), model.cycles);
+	fromConcert(*(tdata->volts), model.voltage);
+	fromConcert(*(tdata->freqs), model.frequency);
+
+	return corpus.add(model) ? 0 : -EIO;
+}
+
 void leave(int sig) {
 	/* clean up procedure */
 }
@@ -349,6 +366,8 @@ int main(int argc, char *argv[])
 	char *freq_file_name = NULL;
 	char *solvers_file_name = NULL;
 	char *range_file_name = NULL;
+	char *corpus_file_name = NULL;
+	CorpusWriter corpus;
 	vector <string> solvers;
 	vector <double> timeset;
 	vector <double> energyset;
@@ -409,6 +428,13 @@ int main(int argc, char *argv[])
 			}
 			location = string(optarg);
 			break;
+		case 'b':   /* -b or --corpus */
+			if (!optarg) {
+				printf("Specify the corpus file to output the models.\n");
+				return -EINVAL;
+			}
+			corpus_file_name = optarg;
+			break;
 		case 'n':   /* -n or --task-count */
 			if (!optarg) {
 				printf("Specify the number of tasks.\n");
@@ -528,6 +554,11 @@ int main(int argc, char *argv[])
 	 *		       for a given simulation setup.
 	 */
 
+	if (corpus_file_name && !corpus.open(corpus_file_name)) {
+		cerr << "Error opening corpus file " << corpus_file_name << endl;
+		return -EINVAL;
+	}
+
 	i = 0;
 	while (i++ < nmodels) {
 
@@ -542,7 +573,21 @@ int main(int argc, char *argv[])
 			err = gen_task_model(ntasks, nprocs, env, *(tdata->priority),
 					*(tdata->period), *(tdata->deadline),
 					*(tdata->cycles));
-		write_model(tdata, location);
+		if (corpus_file_name) {
+			err = write_corpus_model(tdata, corpus);
+			if (err < 0) {
+				cerr << "Error writing corpus file " <<
+					corpus_file_name << endl;
+				return err;
+			}
+		} else {
+			write_model(tdata, location);
+		}
+	}
+
+	if (corpus_file_name && !corpus.close()) {
+		cerr << "Error writing corpus file " << corpus_file_name << endl;
+		return -EIO;
 	}
 
 	return err;
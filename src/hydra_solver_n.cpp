@@ -18,15 +18,15 @@
 #include <getopt.h>
 #include <signal.h>
 
-#include <akaroa.H>
-#include <akaroa/distributions.H>
-
-#include <analysis.h>
-#include <gcd_hash.h>
+#include <akaroa_compat.h>
 
 #include <ilcplex/ilocplex.h>
 ILOSTLBEGIN
 
+#include <analysis_concert.h>
+#include <solver.h>
+#include <solver_pool.h>
+
 static double wcec_min = 100, wcec_max = 200;
 static double deadline_min = 10, deadline_max = 50;
 static double period_min = 10, period_max = 50;
@@ -34,13 +34,8 @@ static bool compare_no_lp = 0;
 static bool compute_power = false;
 static IloNumArray2 period_ranges;
 
-/* shared memory */
-/* reflects always the last thread execution */
-struct thread_data {
-	long etimes;
-	bool good;
-	double energyS;
-
+/* task model generated for each sample */
+struct sample_data {
 	IloEnv *env;
 
 	IloNumArray2 *freqs;
@@ -85,7 +80,7 @@ static void print_usage(char *program_name)
 	"  -c  --compare-no-lp                    Compare the difference to test without A_i.\n"
 	"  -p  --compute-power                    Estimate system average energy consumption.\n"
 	"  -f  --freq-file=<file-name>            File name with frequencies per cluster.\n"
-	"  -s  --solvers-file=<file-name>         File name with solvers command line.\n"
+	"  -s  --solvers-file=<file-name>         File name with solvers names or command lines.\n"
 	"  -r  --range-file=<file-name>           File name with task model ranges.\n"
 	"  -n  --task-count=<task-count>          Number of tasks to be generated per task model.\n"
 	"  -l  --switch-latency=<Lp>              Switching Latency.\n"
@@ -289,55 +284,6 @@ static int gen_task_model(int ntasks, int nprocs, IloEnv env, IloNumArray &prior
 	return 0;
 }
 
-bool execute_solver(struct thread_data *tdata, string solver_cmd)
-{
-	std::string result = "", filename = "";
-	ofstream mfile;
-	FILE* pipe;
-	char buffer[128];
-
-	pipe = popen("mktemp fileXXXXXXXX", "r");
-	if (!pipe)
-		return false;
-
-	while (!feof(pipe)) {
-		if (fgets(buffer, 128, pipe) != NULL)
-			filename += buffer;
-	}
-	pclose(pipe);
-
-	filename.erase(filename.size() - 1);
-
-	mfile.open(filename.c_str());
-	mfile << "1" << endl;
-	mfile << *(tdata->priority) << endl;
-	mfile << *(tdata->period) << endl;
-	mfile << *(tdata->deadline) << endl;
-	mfile << *(tdata->cycles) << endl;
-	mfile << *(tdata->volts) << endl;
-	mfile << *(tdata->freqs) << endl;
-	mfile.close();
-
-	result = solver_cmd + " " + filename;
-	pipe = popen(result.c_str(), "r");
-	if (!pipe)
-		return false;
-
-	result = "";
-	while (!feof(pipe)) {
-		if (fgets(buffer, 128, pipe) != NULL)
-			result += buffer;
-	}
-	pclose(pipe);
-	system((std::string("rm -rf ") + filename).c_str());
-
-	int n = sscanf(result.c_str(), "%d %ld %lf", &tdata->good,
-					&tdata->etimes,
-					&tdata->energyS);
-
-	return n == 3; 
-}
-
 void leave(int sig) {
 	/* clean up procedure */
 }
@@ -347,7 +293,10 @@ void leave(int sig) {
  */
 int main(int argc, char *argv[])
 {
-	struct thread_data *tdata;
+	struct sample_data *tdata;
+	mgapModel model;
+	solverLimits limits;
+	solverResult result;
 	IloEnv env;
 	struct runInfo runtime;
 	double Lp = 0.0, max_ui = 0.0, u_total = 0.0;
@@ -464,7 +413,7 @@ int main(int argc, char *argv[])
 	if (err < 0)
 		return err;
 
-	tdata = new (struct thread_data);
+	tdata = new (struct sample_data);
 	tdata->env = &env;
 
 	tdata->freqs = new IloNumArray2(env);
@@ -510,6 +459,14 @@ int main(int argc, char *argv[])
 	for (int j = 0; j < nprocs; j++)
 		tdata->cycles[0][j] = IloNumArray(env, ntasks);
 
+	/* solvers in the config file that are built in run in-process */
+	SolverPool pool(solvers, "fileXXXXXXXX");
+	/* its workers already run side by side, and instances share nodes */
+	limits.threads = 1;
+	model.alpha = 1;
+	fromConcert(*(tdata->volts), model.voltage);
+	fromConcert(*(tdata->freqs), model.frequency);
+
 	/*
 	 * For now we are assuming a fixed number of parameters
 	 * per solver:
@@ -547,21 +504,27 @@ int main(int argc, char *argv[])
 			cerr << "Error while generating task model" << endl;
 			return err;
 		}
+		fromConcert(*(tdata->priority), model.priority);
+		fromConcert(*(tdata->period), model.period);
+		fromConcert(*(tdata->deadline), model.deadline);
+		fromConcert(*(tdata->cycles), model.cycles);
+
+		/* all solvers at once, the sample takes as long as the slowest */
+		pool.solve(model, limits);
 
 		allgood = true;
 		timeset.clear();
 		energyset.clear();
 		for (i = 0; i < nsolvers; i++) {
-			err = execute_solver(tdata, solvers[i]);
-			if (!err) {
+			if (!pool.getResult(i, result)) {
 				allgood = false;
 				continue;
 			}
 
-			cout << tdata->good << " ";
-			if (tdata->good) {
-				timeset.push_back(tdata->etimes);
-				energyset.push_back(tdata->energyS);
+			cout << result.good << " ";
+			if (result.good) {
+				timeset.push_back(result.etimes);
+				energyset.push_back(result.energy);
 			} else {
 				allgood = false;
 			}
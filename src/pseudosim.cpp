@@ -8,7 +8,7 @@
  * published by the Free Software Foundation.
  */
 
-#include <sys/time.h>
+#include <time.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
@@ -16,8 +16,12 @@
 #include <math.h>
 #include <getopt.h>
 #include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
 
-#include <akaroa.H>
+#include <fstream>
+
+#include <akaroa_compat.h>
 
 #include <analysis.h>
 
@@ -27,17 +31,25 @@ static double period_min = 10, period_max = 50;
 static bool compare_no_lp = 0;
 static bool compute_power = false;
 
-static double inline next_ak(double min, double max) {
+/*
+ * Native runs draw each sample from its own stream, the one numbered after
+ * the sample, so results do not depend on the thread count. Akaroa runs
+ * pass no stream and draw from AkRandomReal.
+ */
+static double inline next_ak(RandomStream *stream, double min, double max) {
 	double v;
 
-	v = AkRandomReal();
+	if (stream)
+		v = stream->real();
+	else
+		v = AkRandomReal();
 	v *= (max - min);
 	v += min;
 
 	return v;
 }
 
-static const char *short_options = "hvpf:r:n:m:l:c";
+static const char *short_options = "hvpf:r:n:m:l:cj:s:e:N:";
 static const struct option long_options[] = {
 	{ "help",     0, NULL, 'h' },
 	{ "verbose",  0, NULL, 'v' },
@@ -48,6 +60,10 @@ static const struct option long_options[] = {
 	{ "switch-latency",  required_argument, NULL, 'l' },
 	{ "processor-count",  required_argument, NULL, 'm' },
 	{ "compare-no-lp",  0, NULL, 'c' },
+	{ "threads",  required_argument, NULL, 'j' },
+	{ "seed",  required_argument, NULL, 's' },
+	{ "precision",  required_argument, NULL, 'e' },
+	{ "max-samples",  required_argument, NULL, 'N' },
 	{ NULL,       0, NULL, 0   },   /* Required at end of array.  */
 };
 
@@ -63,7 +79,11 @@ static void print_usage(char *program_name)
 	"  -r  --range-file=<file-name>           File name with task model ranges.\n"
 	"  -n  --task-count=<task-count>          Number of tasks to be generated per task model.\n"
 	"  -l  --switch-latency=<Lp>              Switching Latency.\n"
-	"  -m  --processor-count=<freq-count>     Number of processors per cluster.\n");
+	"  -m  --processor-count=<freq-count>     Number of processors per cluster.\n"
+	"  -j  --threads=<n>                      Run on n threads, 0 for all cores, instead of through the Akaroa calls.\n"
+	"  -s  --seed=<seed>                      Seed of the native run.\n"
+	"  -e  --precision=<relative>             Relative half width of the 95%% intervals to stop at (default 0.05).\n"
+	"  -N  --max-samples=<n>                  Stop the native run after n samples anyway.\n");
 }
 
 static int read_ranges(char *range_file_name)
@@ -84,21 +104,24 @@ int compar(const void *a, const void *b) {
 	return *lb - *la;
 }
 
-static int read_power_model(char *freq_file_name, IloNumArray2 &freqs, IloNumArray2 &pdyn,
-				IloNumArray2 &pstat)
+static int read_power_model(char *freq_file_name, NumArray2 &freqs, NumArray2 &pdyn,
+				NumArray2 &pstat)
 {
 	ifstream file(freq_file_name);
 
-	file >> freqs >> pdyn >> pstat;
+	readArray(file, freqs);
+	readArray(file, pdyn);
+	readArray(file, pstat);
 
 	return 0;
 }
 
-static int read_frequencies(char *freq_file_name, IloNumArray2 &freqs, IloNumArray2 &volts)
+static int read_frequencies(char *freq_file_name, NumArray2 &freqs, NumArray2 &volts)
 {
 	ifstream file(freq_file_name);
 
-	file >> freqs >> volts;
+	readArray(file, freqs);
+	readArray(file, volts);
 
 	return 0;
 }
@@ -110,16 +133,17 @@ static int read_frequencies(char *freq_file_name, IloNumArray2 &freqs, IloNumArr
  * @parameter nresources: integer which represents the number of resources
  * @complexity: O(ntasks x nresources)
  */
-static int gen_task_model(vector <class Task> &tasks, IloEnv env, int ntasks)
+static int gen_task_model(vector <class Task> &tasks, int ntasks,
+				RandomStream *stream)
 {
 	int i = 0;
 
 	for (i = 0; i < ntasks; i++) {
 
-		tasks[i].setPriority(next_ak(1.0, ntasks));
-		tasks[i].setPeriod(next_ak(period_min, period_max));
-		tasks[i].setDeadline(next_ak(period_min, tasks[i].getPeriod()));
-		tasks[i].setWcec(next_ak(wcec_min, wcec_max));
+		tasks[i].setPriority(next_ak(stream, 1.0, ntasks));
+		tasks[i].setPeriod(next_ak(stream, period_min, period_max));
+		tasks[i].setDeadline(next_ak(stream, period_min, tasks[i].getPeriod()));
+		tasks[i].setWcec(next_ak(stream, wcec_min, wcec_max));
 		tasks[i].setIp(0.0); /* do not touch for now */
 		tasks[i].setIb(0.0);/* do not touch for now */
 		tasks[i].setIa(0.0); /* do not touch for now */
@@ -130,7 +154,8 @@ static int gen_task_model(vector <class Task> &tasks, IloEnv env, int ntasks)
 	return 0;
 }
 
-static void gen_assignments(IloNumArray4 &assig, int nclusters, int nprocs, int ntasks, int nfreqs)
+static void gen_assignments(NumArray4 &assig, int nclusters, int nprocs, int ntasks, int nfreqs,
+				RandomStream *stream)
 {
 	int s, i, j, k;
 
@@ -144,51 +169,330 @@ static void gen_assignments(IloNumArray4 &assig, int nclusters, int nprocs, int
 		}
 	}
 	for (j = 0; j < ntasks; j++) {
-		s = (int)floor(next_ak(0.0, (double)nclusters));
-		i = (int)floor(next_ak(0.0, (double)nprocs));
-		k = (int)floor(next_ak(0.0, (double)nfreqs));
+		s = (int)floor(next_ak(stream, 0.0, (double)nclusters));
+		i = (int)floor(next_ak(stream, 0.0, (double)nprocs));
+		k = (int)floor(next_ak(stream, 0.0, (double)nfreqs));
 		assig[s][i][j][k] = 1.0;
 	}
 }
 
-static long get_execution_time(struct timeval s, struct timeval e)
+/*
+ * CPU time of the calling thread, in nanoseconds: native threads sharing
+ * the cores do not add to the timings of one another
+ */
+static long long thread_time(void)
 {
-	struct timeval diff;
+	struct timespec t;
 
-	timersub(&e, &s, &diff);
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
 
-	return diff.tv_sec * 1000000 + diff.tv_usec;
+	return (long long)t.tv_sec * 1000000000LL + t.tv_nsec;
 }
 
 void leave(int sig) {
 	/* clean up procedure */
 }
 
+/* Everything a sample needs, shared read only by the native threads */
+struct simModel {
+	runInfo runtime;
+	double Lp;
+	int nclusters;
+	int nprocs;
+	int ntasks;
+	int nfreqs;
+	int nparams;		/* observations per sample */
+	NumArray2 freqs;
+	NumArray2 volts;
+	NumArray2 pdyn;
+	NumArray2 pidle;
+};
+
+/*
+ * run_sample: generates one task set and assignment, analyses it with and
+ * without Lp and stores the sim.nparams observations into obs
+ * @complexity: O(nfrequencies) + O(nresources x ntasks ^ 2)
+ */
+static int run_sample(struct simModel &sim, vector <class Task> &tasks,
+			NumArray4 &assig, RandomStream *stream, double *obs)
+{
+	long long st;
+	double times[6];	/* microseconds */
+	double sp, ui = 0.0, n = sim.ntasks, energy;
+	bool u_edf, u_ll, r;
+	bool u_edf0, u_ll0, r0;
+	int err;
+
+	/* O(nfrequencies) + O(ntasks x nresources) */
+	err = gen_task_model(tasks, sim.ntasks, stream);
+	if (err < 0)
+		return err;
+	gen_assignments(assig, sim.nclusters, sim.nprocs, sim.ntasks,
+			sim.nfreqs, stream);
+	SchedulabilityAnalysis *sched;
+	if (compute_power)
+		sched = new SchedulabilityAnalysis(sim.runtime, sim.ntasks,
+					0, /* nresources */
+					sim.Lp, /* Lp */
+					sim.freqs, sim.pdyn, sim.pidle, tasks, assig);
+	else
+		sched = new SchedulabilityAnalysis(sim.runtime, sim.ntasks,
+					0, /* nresources */
+					sim.Lp, /* Lp */
+					sim.freqs, sim.volts, tasks, assig);
+	st = thread_time();
+	sched->computeAnalysis();
+	times[0] = (thread_time() - st) / 1000.0;
+
+	st = thread_time();
+	u_edf = sched->evaluateUtilization(1.0, ui);
+	times[1] = (thread_time() - st) / 1000.0;
+
+	st = thread_time();
+	u_ll = sched->evaluateUtilization(n * (pow(2.0, 1.0 / n) - 1.0), ui);
+	times[2] = (thread_time() - st) / 1000.0;
+
+	r = sched->evaluateResponse(sp);
+
+	/* only the power model has what the energy needs */
+	energy = compute_power ? sched->computeSystemEnergy() : 0.0;
+
+	delete sched;
+
+	SchedulabilityAnalysis sched0(sim.runtime, sim.ntasks,
+				0, /* nresources */
+				0.0, /* Lp */
+				sim.freqs, sim.volts, tasks, assig);
+
+	st = thread_time();
+	sched0.computeAnalysis();
+	times[3] = (thread_time() - st) / 1000.0;
+
+	st = thread_time();
+	u_edf0 = sched0.evaluateUtilization(1.0, ui);
+	times[4] = (thread_time() - st) / 1000.0;
+
+	st = thread_time();
+	u_ll0 = sched0.evaluateUtilization(n * (pow(2.0, 1.0 / n) - 1.0), ui);
+	times[5] = (thread_time() - st) / 1000.0;
+
+	r0 = sched0.evaluateResponse(sp);
+
+	if (compare_no_lp) {
+		obs[0] = r - u_edf0;
+		obs[1] = r - u_ll0;
+		obs[2] = r - r0;
+		obs[3] = ui;
+		obs[4] = times[0]; /* R Lp */
+		obs[5] = times[3]; /* R_0 */
+		obs[6] = times[4]; /* u_edf0 */
+		obs[7] = times[5]; /* u_ll0 */
+		if (compute_power)
+			obs[8] = energy; /* power */
+	} else {
+		obs[0] = r - u_edf;
+		obs[1] = r - u_ll;
+		obs[2] = ui;
+		obs[3] = times[0]; /* R Lp */
+		obs[4] = times[1]; /* u_edf */
+		obs[5] = times[2]; /* u_ll */
+		if (compute_power)
+			obs[6] = energy; /* power */
+	}
+
+	return 0;
+}
+
+/* timing_param: whether observation p of run_sample() is a timing */
+static bool timing_param(int p)
+{
+	if (compare_no_lp)
+		return p >= 4 && p <= 7;
+
+	return p >= 3 && p <= 5;
+}
+
+/*
+ * Native runs: samples are handed out in rounds of a fixed size to
+ * threads that live for the whole run and wait for each round on a
+ * condition variable, keeping their scratch task set across rounds.
+ */
+#define SAMPLES_PER_ROUND	1024
+#define SAMPLES_PER_TAKE	16	/* taken by a thread at once */
+
+struct simRound {
+	struct simModel *sim;
+	uint64_t seed;
+	unsigned long first;	/* index of the first sample of the round */
+	int count;
+	int next;		/* next sample of the round to run */
+	int err;
+	vector <double> obs;	/* count x nparams, in sample order */
+	pthread_mutex_t lock;
+	pthread_cond_t start;
+	pthread_cond_t done;
+	unsigned long round;	/* bumped for each round */
+	int pending;		/* threads still in it */
+	bool quit;
+};
+
+/* takes samples of the current round until there are none left */
+static void run_takes(struct simRound *round, vector <class Task> &tasks,
+			NumArray4 &assig, RandomStream &stream)
+{
+	struct simModel &sim = *round->sim;
+	int i, last, err = 0;
+
+	for (;;) {
+		pthread_mutex_lock(&round->lock);
+		i = round->next;
+		round->next += SAMPLES_PER_TAKE;
+		pthread_mutex_unlock(&round->lock);
+		if (i >= round->count)
+			break;
+
+		last = min(i + SAMPLES_PER_TAKE, round->count);
+		for (; i < last && err == 0; i++) {
+			stream.setStream(round->seed, round->first + i);
+			err = run_sample(sim, tasks, assig, &stream,
+						&round->obs[i * sim.nparams]);
+		}
+		if (err < 0) {
+			pthread_mutex_lock(&round->lock);
+			round->err = err;
+			pthread_mutex_unlock(&round->lock);
+			break;
+		}
+	}
+}
+
+static void *run_rounds(void *data)
+{
+	struct simRound *round = (struct simRound *)data;
+	struct simModel &sim = *round->sim;
+	vector <class Task> tasks(sim.nclusters * sim.nprocs * sim.ntasks);
+	NumArray4 assig(sim.nclusters, NumArray3(sim.nprocs,
+				NumArray2(sim.ntasks, NumArray(sim.nfreqs, 0.0))));
+	RandomStream stream;
+	unsigned long seen = 0;
+
+	pthread_mutex_lock(&round->lock);
+	for (;;) {
+		while (round->round == seen && !round->quit)
+			pthread_cond_wait(&round->start, &round->lock);
+		if (round->quit)
+			break;
+		seen = round->round;
+		pthread_mutex_unlock(&round->lock);
+
+		run_takes(round, tasks, assig, stream);
+
+		pthread_mutex_lock(&round->lock);
+		if (--round->pending == 0)
+			pthread_cond_signal(&round->done);
+	}
+	pthread_mutex_unlock(&round->lock);
+
+	return NULL;
+}
+
+/*
+ * run_native: runs rounds of samples on nthreads threads until the
+ * estimator is over and prints the estimates. Observations reach the
+ * estimator in sample order and the timings, which vary from run to run,
+ * do not decide when it is over: the number of samples and the estimates
+ * of all but the timings only depend on the seed.
+ */
+static int run_native(struct simModel &sim, int nthreads,
+			const statisticsParams &params)
+{
+	SequentialEstimator estimator(sim.nparams, params);
+	vector <pthread_t> threads;
+	struct simRound round;
+	unsigned long samples = 0;
+	int i, p;
+
+	for (p = 0; p < sim.nparams; p++)
+		estimator.setStopping(p, !timing_param(p));
+
+	if (nthreads <= 0)
+		nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nthreads <= 0)
+		nthreads = 1;
+	threads.resize(nthreads);
+
+	round.sim = &sim;
+	round.seed = params.seed;
+	round.err = 0;
+	round.obs.resize(SAMPLES_PER_ROUND * sim.nparams);
+	round.round = 0;
+	round.pending = 0;
+	round.quit = false;
+	pthread_mutex_init(&round.lock, NULL);
+	pthread_cond_init(&round.start, NULL);
+	pthread_cond_init(&round.done, NULL);
+	for (i = 0; i < nthreads; i++)
+		pthread_create(&threads[i], NULL, run_rounds, &round);
+
+	while (!estimator.over()) {
+		pthread_mutex_lock(&round.lock);
+		round.first = samples;
+		round.count = SAMPLES_PER_ROUND;
+		if (params.maxObs && params.maxObs - samples < SAMPLES_PER_ROUND)
+			round.count = params.maxObs - samples;
+		round.next = 0;
+		round.pending = nthreads;
+		round.round++;
+		pthread_cond_broadcast(&round.start);
+		while (round.pending > 0)
+			pthread_cond_wait(&round.done, &round.lock);
+		pthread_mutex_unlock(&round.lock);
+
+		if (round.err < 0) {
+			printf("Error while generating task model\n");
+			break;
+		}
+
+		for (i = 0; i < round.count; i++)
+			for (p = 0; p < sim.nparams; p++)
+				estimator.observe(p, round.obs[i * sim.nparams + p]);
+		samples += round.count;
+	}
+
+	pthread_mutex_lock(&round.lock);
+	round.quit = true;
+	pthread_cond_broadcast(&round.start);
+	pthread_mutex_unlock(&round.lock);
+	for (i = 0; i < nthreads; i++)
+		pthread_join(threads[i], NULL);
+	pthread_cond_destroy(&round.done);
+	pthread_cond_destroy(&round.start);
+	pthread_mutex_destroy(&round.lock);
+
+	estimator.report(cout);
+
+	return round.err;
+}
+
 /*
  * @complexity: O(nfrequencies ^ ntasks) x O(nresources x ntasks ^ 2)
  */
 int main(int argc, char *argv[])
 {
-	struct timeval st, e;
-	long times[6];
-	IloEnv env;
 	vector <class Task> tasks;
-	IloNumArray2 freqs(env);
-	IloNumArray2 volts(env);
-	IloNumArray2 pdyn(env);
-	IloNumArray2 pidle(env);
-	struct runInfo runtime;
-	double Lp = 0.0;
-	int nclusters = 0;
-	int nprocs = 0;
-	int ntasks = 0;
-	int nfreqs = 0;
+	struct simModel sim;
+	vector <double> obs;
+	statisticsParams params;
+	int nthreads = -1;
 	int next_option;
 	int err = 0;
-	int s, i, j, k;
+	int s, i, j;
 	char *freq_file_name = NULL;
 	char *range_file_name = NULL;
 
+	sim.Lp = 0.0;
+	sim.nclusters = sim.nprocs = sim.ntasks = sim.nfreqs = 0;
+
 	(void) signal(SIGTERM,leave);
 
 	/* Read command line options */
@@ -203,7 +507,7 @@ int main(int argc, char *argv[])
 			print_usage(argv[0]);
 			return 0;
 		case 'v':   /* -v or --verbose */
-			runtime.setVerbose(true);
+			sim.runtime.setVerbose(true);
 			break;
 		case 'c':   /* -c or --compare_no_lp */
 			compare_no_lp = true;
@@ -216,21 +520,21 @@ int main(int argc, char *argv[])
 				printf("Specify the frequency switching latency.\n");
 				return -EINVAL;
 			}
-			Lp = strtod(optarg, NULL);
+			sim.Lp = strtod(optarg, NULL);
 			break;
 		case 'n':   /* -n or --task-count */
 			if (!optarg) {
 				printf("Specify the number of tasks.\n");
 				return -EINVAL;
 			}
-			ntasks = strtol(optarg, NULL, 10);
+			sim.ntasks = strtol(optarg, NULL, 10);
 			break;
 		case 'm':   /* -m or --processor-count */
 			if (!optarg) {
 				printf("Specify the number of frequencies.\n");
 				return -EINVAL;
 			}
-			nprocs = strtol(optarg, NULL, 10);
+			sim.nprocs = strtol(optarg, NULL, 10);
 			break;
 		case 'f':   /* -f or --freq-file */
 			if (!optarg) {
@@ -248,15 +552,28 @@ int main(int argc, char *argv[])
 			}
 			range_file_name = optarg;
 			break;
+		case 'j':   /* -j or --threads */
+			nthreads = strtol(optarg, NULL, 10);
+			break;
+		case 's':   /* -s or --seed */
+			params.seed = strtoull(optarg, NULL, 10);
+			break;
+		case 'e':   /* -e or --precision */
+			params.relError = strtod(optarg, NULL);
+			break;
+		case 'N':   /* -N or --max-samples */
+			params.maxObs = strtoul(optarg, NULL, 10);
+			break;
 		case -1:    /* Done with options.  */
 			break;
 		}
 	} while (next_option != -1);
 
 	if (compute_power)
-		err = read_power_model(freq_file_name, freqs, pdyn, pidle);
+		err = read_power_model(freq_file_name, sim.freqs, sim.pdyn,
+					sim.pidle);
 	else
-		err = read_frequencies(freq_file_name, freqs, volts);
+		err = read_frequencies(freq_file_name, sim.freqs, sim.volts);
 
 	if (err < 0)
 		return err;
@@ -265,124 +582,39 @@ int main(int argc, char *argv[])
 	if (err < 0)
 		return err;
 
-	nclusters = freqs.getSize();
-	nfreqs = freqs[0].getSize();
+	sim.nclusters = sim.freqs.size();
+	sim.nfreqs = sim.nclusters ? sim.freqs[0].size() : 0;
 
-	if (nclusters == 0 || ntasks == 0 || nprocs == 0 || nfreqs == 0) {
+	if (sim.nclusters == 0 || sim.ntasks == 0 || sim.nprocs == 0 ||
+	    sim.nfreqs == 0) {
 		print_usage(argv[0]);
 		return -EINVAL;
 	}
 
-	IloNumArray4 assig(env, nclusters);
+	sim.nparams = (compare_no_lp ? 8 : 6) + (compute_power ? 1 : 0);
 
-	for (s = 0; s < nclusters; s++) {
-		assig[s] = IloNumArray3(env, nprocs);
-		for (i = 0; i < nprocs; i++) {
-			assig[s][i] = IloNumArray2(env, ntasks);
-			for (j = 0; j < ntasks; j++) {
-				assig[s][i][j] = IloNumArray(env, nfreqs);
-				for (k = 0; k < nfreqs; k++) {
-					assig[s][i][j][k] = 0;
-				}
-				Task t(env);
-				tasks.push_back(t);
-			}
-		}
-	}
+	if (nthreads >= 0)
+		return run_native(sim, nthreads, params);
 
+	NumArray4 assig(sim.nclusters, NumArray3(sim.nprocs,
+				NumArray2(sim.ntasks, NumArray(sim.nfreqs, 0.0))));
 
-	if (compare_no_lp)
-		AkDeclareParameters(8 + (compute_power ? 1 : 0));
-	else
-		AkDeclareParameters(6 + (compute_power ? 1 : 0));
+	for (s = 0; s < sim.nclusters; s++)
+		for (i = 0; i < sim.nprocs; i++)
+			for (j = 0; j < sim.ntasks; j++)
+				tasks.push_back(Task());
 
-	while (!AkSimulationOver()) {
-		double sp, ui, n = ntasks, energy;
-		bool u_edf, u_ll, r;
-		bool u_edf0, u_ll0, r0;
+	obs.resize(sim.nparams);
+	AkDeclareParameters(sim.nparams);
 
-		/* O(nfrequencies) + O(ntasks x nresources) */
-		err = gen_task_model(tasks, env, ntasks);
+	while (!AkSimulationOver()) {
+		err = run_sample(sim, tasks, assig, NULL, &obs[0]);
 		if (err < 0) {
 			printf("Error while generating task model\n");
 			return err;
 		}
-		gen_assignments(assig, nclusters, nprocs, ntasks, nfreqs);
-		SchedulabilityAnalysis *sched;
-		if (compute_power)
-			sched = new SchedulabilityAnalysis(env, runtime, ntasks,
-						0, /* nresources */
-						Lp, /* Lp */
-						freqs, pdyn, pidle, tasks, assig);
-		else
-			sched = new SchedulabilityAnalysis(env, runtime, ntasks,
-						0, /* nresources */
-						Lp, /* Lp */
-						freqs, volts, tasks, assig);
-		gettimeofday(&st, NULL);
-		sched->computeAnalysis();
-		gettimeofday(&e, NULL);
-		times[0] = get_execution_time(st, e);
-
-		gettimeofday(&st, NULL);
-		u_edf = sched->evaluateUtilization(1.0, ui);
-		gettimeofday(&e, NULL);
-		times[1] = get_execution_time(st, e);
-
-		gettimeofday(&st, NULL);
-		u_ll = sched->evaluateUtilization(n * (pow(2.0, 1.0 / n) - 1.0), ui);
-		gettimeofday(&e, NULL);
-		times[2] = get_execution_time(st, e);
-
-		r = sched->evaluateResponse(sp);
-
-		energy = sched->computeSystemEnergy();
-
-		delete sched;
-
-		SchedulabilityAnalysis sched0(env, runtime, ntasks,
-					0, /* nresources */
-					0.0, /* Lp */
-					freqs, volts, tasks, assig);
-
-		gettimeofday(&st, NULL);
-		sched0.computeAnalysis();
-		gettimeofday(&e, NULL);
-		times[3] = get_execution_time(st, e);
-
-		gettimeofday(&st, NULL);
-		u_edf0 = sched0.evaluateUtilization(1.0, ui);
-		gettimeofday(&e, NULL);
-		times[4] = get_execution_time(st, e);
-
-		gettimeofday(&st, NULL);
-		u_ll0 = sched0.evaluateUtilization(n * (pow(2.0, 1.0 / n) - 1.0), ui);
-		gettimeofday(&e, NULL);
-		times[5] = get_execution_time(st, e);
-
-		r0 = sched0.evaluateResponse(sp);
-
-		if (compare_no_lp) {
-			AkParamObservation(1, r - u_edf0);
-			AkParamObservation(2, r - u_ll0);
-      			AkParamObservation(3, r - r0);
-			AkParamObservation(4, ui);
-			AkParamObservation(5, times[0]); /* R Lp */
-			AkParamObservation(6, times[3]); /* R_0 */
-			AkParamObservation(7, times[4]); /* u_edf0 */
-			AkParamObservation(8, times[5]); /* u_ll0 */
-			if (compute_power)
-				AkParamObservation(9, energy); /* power */
-		} else {
-			AkParamObservation(1, r - u_edf);
-			AkParamObservation(2, r - u_ll);
-			AkParamObservation(3, ui);
-			AkParamObservation(4, times[0]); /* R Lp */
-			AkParamObservation(5, times[1]); /* u_edf */
-			AkParamObservation(6, times[2]); /* u_ll */
-			if (compute_power)
-				AkParamObservation(7, energy); /* power */
-		}
+		for (i = 0; i < sim.nparams; i++)
+			AkParamObservation(i + 1, obs[i]);
 	}
 
 	return err;
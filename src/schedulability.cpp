@@ -16,9 +16,6 @@
 #include <math.h>
 #include <getopt.h>
 
-#include <ilcplex/ilocplex.h>
-ILOSTLBEGIN
-
 #include <analysis.h>
 
 static const char *short_options = "hvstlrm:";
@@ -51,7 +48,7 @@ static void print_usage(char *program_name)
  * @parameter stat: information about the execution
  * @complexity: O(ntasks)
  */
-static void print_summary(SchedulabilityAnalysis sched)
+static void print_summary(SchedulabilityAnalysis &sched)
 {
 	double spread, u, energy;
 	bool utilization, response;
@@ -121,7 +118,6 @@ static void print_summary(SchedulabilityAnalysis sched)
  */
 int main(int argc, char *argv[])
 {
-	IloEnv env;
 	const char *filename = "model.txt";
 	runInfo runtime;
 	int next_option;
@@ -161,7 +157,7 @@ int main(int argc, char *argv[])
 		}
 	} while (next_option != -1);
 
-	SchedulabilityAnalysis sched(env, runtime, filename, true);
+	SchedulabilityAnalysis sched(runtime, filename, true);
 	sched.computeAnalysis();
 
 	/* Compute output data */
@@ -0,0 +1,74 @@
+/*
+ * src/solver.cpp
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <map>
+
+#include <solver.h>
+
+/* Function local, so registrations from static constructors find it */
+static map <string, solverFactory> &solverRegistry(void)
+{
+	static map <string, solverFactory> registry;
+
+	return registry;
+}
+
+void registerSolver(const string &name, solverFactory factory)
+{
+	solverRegistry()[name] = factory;
+}
+
+/* Returns NULL when no solver is registered under name */
+Solver *createSolver(const string &name)
+{
+	map <string, solverFactory>::iterator it = solverRegistry().find(name);
+
+	if (it == solverRegistry().end())
+		return NULL;
+
+	return it->second();
+}
+
+vector <string> solverNames(void)
+{
+	map <string, solverFactory>::iterator it;
+	vector <string> names;
+
+	for (it = solverRegistry().begin(); it != solverRegistry().end(); it++)
+		names.push_back(it->first);
+
+	return names;
+}
+
+ostream &writeModel(ostream &os, const mgapModel &model)
+{
+	os << model.alpha << endl;
+	writeArray(os, model.priority) << endl;
+	writeArray(os, model.period) << endl;
+	writeArray(os, model.deadline) << endl;
+	writeArray(os, model.cycles) << endl;
+	writeArray(os, model.voltage) << endl;
+	writeArray(os, model.frequency) << endl;
+
+	return os;
+}
+
+istream &readModel(istream &is, mgapModel &model)
+{
+	is >> model.alpha;
+	readArray(is, model.priority);
+	readArray(is, model.period);
+	readArray(is, model.deadline);
+	readArray(is, model.cycles);
+	readArray(is, model.voltage);
+	readArray(is, model.frequency);
+
+	return is;
+}
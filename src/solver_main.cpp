@@ -0,0 +1,321 @@
+/*
+ * src/solver_main.cpp
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+/*
+ * Command line front end shared by the solver_mgap_* programs. Each one is
+ * this file built with SOLVER_NAME set to the registered solver it runs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <errno.h>
+
+#include <fstream>
+#include <iostream>
+
+#include <corpus.h>
+#include <solver.h>
+
+#ifndef SOLVER_NAME
+#error "SOLVER_NAME must name the registered solver to run"
+#endif
+
+static const char *short_options = "hsd:tm:riun:bj:owR";
+static const struct option long_options[] = {
+	{ "help",     0, NULL, 'h' },
+	{ "model",     0, NULL, 'm' },
+	{ "deadline",     required_argument, NULL, 'd' },
+	{ "solution",     0, NULL, 's' },
+	{ "initial-point",     0, NULL, 'i' },
+	{ "upper-cut",     0, NULL, 'u' },
+	{ "relax-integrity",     0, NULL, 'r' },
+	{ "statistics",     0, NULL, 't' },
+	{ "model-index",     required_argument, NULL, 'n' },
+	{ "batch",     0, NULL, 'b' },
+	{ "threads",     required_argument, NULL, 'j' },
+	{ "opportunistic",     0, NULL, 'o' },
+	{ "no-warm-start",     0, NULL, 'w' },
+	{ "no-rounding",     0, NULL, 'R' },
+	{ NULL,       0, NULL, 0   },   /* Required at end of array.  */
+};
+
+static void print_usage(char *program_name)
+{
+	printf("Usage: %s  options [model files]\n", program_name);
+	printf(
+	"  -h  --help                             Display this usage information.\n"
+	"  -m  --model=<modelfile>                Read model specification from modelfile.\n"
+	"  -n  --model-index=<index>              Model to solve when modelfile is a corpus.\n"
+	"  -u  --upper-cut                        Upper cut from modelfile.\n"
+	"  -d  --deadline=<seconds>               Limit the execution to seconds.\n"
+	"  -s  --solution                         Print at the end the found solution.\n"
+	"  -i  --initial-point		  	  Start search from a known solution as starting point (read from model).\n"
+	"  -r  --relax-integrity		  Execute with relaxed integrity.\n"
+	"  -t  --statistics                       Print at the end the feasibility, processing time, minimum energy found,\n"
+	"                                         gap and deterministic time in ticks.\n"
+	"  -b  --batch                            Solve every model of the corpus, or every model file given,\n"
+	"                                         printing one line per model: model, feasibility, time, energy, gap and ticks.\n"
+	"  -j  --threads=<threads>                CPLEX threads, 0 for one per core (by default 1,\n"
+	"                                         and the CPLEX default for rm_enrico).\n"
+	"  -o  --opportunistic                    Let parallel runs differ from one another, for speed.\n"
+	"  -w  --no-warm-start                    Without -i, do not start from the heuristic solution and cut off at it.\n"
+	"  -R  --no-rounding                      Do not round node relaxations into solutions during the search.\n");
+
+}
+
+static bool read_text_model(const char *filename, bool cut, bool init,
+				mgapModel &model, solverLimits &limits)
+{
+	ifstream file(filename);
+
+	if (!file) {
+		cerr << "ERROR: could not open file '" << filename
+			<< "' for reading" << endl;
+		return false;
+	}
+	/* float array(nTasks) matrix(nAgents x nTasks) matrix(nAgents x nLevels) matrix(nAgents x nLevels) */
+	readModel(file, model);
+	if (cut)
+		file >> limits.upperCut;
+	if (init)
+		readArray(file, limits.start);
+	if (!file || model.cycles.empty() || model.frequency.empty()) {
+		cerr << "ERROR: could not parse model file '" << filename
+			<< "'" << endl;
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * One line per model, flushed as soon as the model is solved so that a
+ * consumer can follow a long batch.
+ */
+static void print_record(ostream &out, const char *name, int index,
+				bool solved, const solverResult &result)
+{
+	if (name)
+		out << name;
+	else
+		out << index;
+	if (solved)
+		out << " " << result.good << " " << result.etimes << " "
+			<< result.energy << " " << result.gap << " "
+			<< result.ticks << endl;
+	else
+		out << " error" << endl;
+}
+
+/*
+ * Solves the models one after the other on the same solver, which keeps
+ * whatever it can (CPLEX environment, licence) from one model to the next.
+ */
+static int solve_batch(Solver *solver, const char *filename, int nfiles,
+			char **files, bool cut, bool init, bool solution,
+			const solverLimits &defaults)
+{
+	mgapModel model;
+	solverLimits limits;
+	solverResult result;
+	bool solved;
+	int i, ret = 0;
+
+	if (nfiles == 0) {
+		Corpus corpus;
+
+		if (cut || init) {
+			cerr << "ERROR: upper cut and initial point are only read"
+				" from text models" << endl;
+			return -EINVAL;
+		}
+		if (!corpus.open(filename)) {
+			cerr << "ERROR: '" << filename << "' is not a model corpus"
+				<< endl;
+			return -EINVAL;
+		}
+		for (i = 0; i < corpus.size(); i++) {
+			if (!corpus.get(i, model)) {
+				cerr << "ERROR: could not read model " << i
+					<< " from corpus '" << filename << "'" << endl;
+				print_record(cout, NULL, i, false, result);
+				ret = -1;
+				continue;
+			}
+			result = solverResult();
+			solved = solver->solve(model, defaults, result);
+			print_record(cout, NULL, i, solved, result);
+			if (solved && solution)
+				solver->dumpSolution();
+		}
+		return ret;
+	}
+
+	for (i = 0; i < nfiles; i++) {
+		limits = defaults;
+		if (!read_text_model(files[i], cut, init, model, limits)) {
+			print_record(cout, files[i], i, false, result);
+			ret = -1;
+			continue;
+		}
+		result = solverResult();
+		solved = solver->solve(model, limits, result);
+		print_record(cout, files[i], i, solved, result);
+		if (solved && solution)
+			solver->dumpSolution();
+	}
+
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	const char* filename  = "mgap-rm.dat";
+	bool stats = false, solution = false, init = false, cut = false;
+	bool batch = false;
+	int next_option;
+	int index = 0;
+	mgapModel model;
+	solverLimits limits;
+	solverResult result;
+	Solver *solver;
+
+	/* each solver keeps the threads of the earlier runs, see setParallel */
+	limits.threads = -1;
+
+	/* Read command line options */
+	do {
+		next_option = getopt_long (argc, argv, short_options,
+						long_options, NULL);
+		switch (next_option) {
+		default:    /* Something else: unexpected.  */
+		case '?':   /* The user specified an invalid option.  */
+		case 'h':   /* -h or --help */
+			print_usage(argv[0]);
+			return 0;
+		case 'd':   /* -d or --deadline */
+			if (!optarg) {
+				fprintf(stderr, "Specify the number of seconds.\n");
+				print_usage(argv[0]);
+				return -EINVAL;
+			}
+			limits.seconds = strtod(optarg, NULL);
+			break;
+		case 'm':   /* -m or --model */
+			if (!optarg) {
+				fprintf(stderr, "Specify file with model.\n");
+				print_usage(argv[0]);
+				return -EINVAL;
+			}
+			filename = optarg;
+			break;
+		case 's':   /* -s or --solution */
+			solution = true;
+			break;
+		case 'r':   /* -r or --relax-integrity */
+			limits.relaxIntegrity = true;
+			break;
+		case 'i':   /* -r or --initial-point */
+			init = true;
+			break;
+		case 'u':   /* -u or --upper-cutt */
+			cut = true;
+			break;
+		case 't':   /* -t or --statistics */
+			stats = true;
+			break;
+		case 'n':   /* -n or --model-index */
+			if (!optarg) {
+				fprintf(stderr, "Specify the model index.\n");
+				print_usage(argv[0]);
+				return -EINVAL;
+			}
+			index = strtol(optarg, NULL, 10);
+			break;
+		case 'b':   /* -b or --batch */
+			batch = true;
+			break;
+		case 'j':   /* -j or --threads */
+			if (!optarg) {
+				fprintf(stderr, "Specify the number of threads.\n");
+				print_usage(argv[0]);
+				return -EINVAL;
+			}
+			limits.threads = strtol(optarg, NULL, 10);
+			break;
+		case 'o':   /* -o or --opportunistic */
+			limits.opportunistic = true;
+			break;
+		case 'w':   /* -w or --no-warm-start */
+			limits.warmStart = false;
+			break;
+		case 'R':   /* -R or --no-rounding */
+			limits.rounding = false;
+			break;
+		case -1:    /* Done with options.  */
+			break;
+		}
+	} while (next_option != -1);
+
+	if (batch) {
+		int ret;
+
+		solver = createSolver(SOLVER_NAME);
+		if (!solver) {
+			cerr << "ERROR: " << SOLVER_NAME << " is not built in" << endl;
+			return -1;
+		}
+		ret = solve_batch(solver, filename, argc - optind, argv + optind,
+					cut, init, solution, limits);
+		delete solver;
+		return ret;
+	}
+
+	if (Corpus::isCorpus(filename)) {
+		Corpus corpus;
+
+		if (cut || init) {
+			cerr << "ERROR: upper cut and initial point are only read"
+				" from text models" << endl;
+			return -EINVAL;
+		}
+		if (!corpus.open(filename) || !corpus.get(index, model)) {
+			cerr << "ERROR: could not read model " << index
+				<< " from corpus '" << filename << "'" << endl;
+			return -1;
+		}
+	} else if (!read_text_model(filename, cut, init, model, limits)) {
+		cerr << "usage:   " << argv[0] << " <file>" << endl;
+		return -1;
+	}
+
+	solver = createSolver(SOLVER_NAME);
+	if (!solver) {
+		cerr << "ERROR: " << SOLVER_NAME << " is not built in" << endl;
+		return -1;
+	}
+
+	if (solver->solve(model, limits, result)) {
+		if (stats) {
+			cout << result.good << endl;
+			cout << result.etimes << endl;
+			cout << result.energy << endl;
+			cout << result.gap << endl;
+			cout << result.ticks << endl;
+		}
+
+		if (solution)
+			solver->dumpSolution();
+	}
+	delete solver;
+
+	return 0;
+}
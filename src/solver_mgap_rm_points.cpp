@@ -0,0 +1,360 @@
+#include <sys/time.h>
+#include <math.h>
+#include <algorithm>
+#include <ilcplex/ilocplex.h>
+#include <analysis_concert.h>
+#include <solver.h>
+#include <cplex_solver.h>
+#include <coefficients.h>
+
+ILOSTLBEGIN
+
+/*
+ * Exact RM test inside the model, as scheduling points. Task j on agent i
+ * meets its deadline iff, for some point t of its testing set,
+ *
+ *   C_j + sum over h in hp(j) on agent i of ceil(t / T_h) C_h <= t
+ *
+ * Each (agent, task, point) gets a binary choosing the point that holds,
+ * and the inequality is relaxed by a big-M when it is not chosen, so no
+ * callback is needed and the LP relaxation sees the response times.
+ */
+
+/* orders tasks by decreasing priority, then by index */
+struct higherPriority {
+	const NumArray &priority;
+
+	higherPriority(const NumArray &priority)
+		:priority(priority)
+	{
+	}
+	bool operator()(int a, int b) const
+	{
+		return priority[a] > priority[b] ||
+			(priority[a] == priority[b] && a < b);
+	}
+};
+
+/*
+ * Points are multiples of the periods, t = n T_h rounded, and t / T_h
+ * rounds back to one ulp above n often enough for ceil to count a job
+ * that is released at t, not before it. Jobs are counted with a relative
+ * tolerance, far above the rounding error and far below any gap between
+ * a point and a release that is not at it.
+ */
+#define JOBS_TOLERANCE	1e-12
+
+/*
+ * jobsBefore: jobs of period T released in [0, t)
+ * @complexity: O(1)
+ */
+static double jobsBefore(double t, double T)
+{
+	return ceil(t / T * (1.0 - JOBS_TOLERANCE));
+}
+
+/*
+ * jobsUpTo: jobs of period T released in [0, t]
+ * @complexity: O(1)
+ */
+static double jobsUpTo(double t, double T)
+{
+	return floor(t / T * (1.0 + JOBS_TOLERANCE));
+}
+
+/*
+ * testingPoints: Bini and Buttazzo's reduced set of task j against all
+ * the tasks of strictly higher priority, hp by decreasing priority:
+ * P_0(t) = {t}, P_h(t) = P_h-1(floor(t / T_h) T_h) u P_h-1(t), from D_j.
+ * The set of a subset of hp is a subset of it, so it is exact whichever
+ * of them share the agent of j.
+ * @complexity: O(hp x points)
+ */
+static void testingPoints(const mgapModel &mgap, int j, const vector <int> &hp,
+				NumArray &points)
+{
+	int h, p, n;
+
+	points.assign(1, mgap.deadline[j]);
+	for (h = hp.size() - 1; h >= 0; h--) {
+		double T = mgap.period[hp[h]];
+
+		n = points.size();
+		for (p = 0; p < n; p++) {
+			double t = jobsUpTo(points[p], T) * T;
+
+			if (t > 0.0)
+				points.push_back(t);
+		}
+		sort(points.begin(), points.end());
+		points.erase(unique(points.begin(), points.end()), points.end());
+	}
+}
+
+class RMPointsSolver : public Solver {
+private:
+	IloEnv env;		/* both kept across models */
+	IloCplex cplex;
+	mgapModel mgap;		/* last instance solved */
+	NumArray3 solution;	/* and its solution, empty if none */
+	double objValue;
+public:
+	RMPointsSolver(void)
+		:objValue(0.0)
+	{
+	}
+	~RMPointsSolver()
+	{
+		env.end();
+	}
+	bool solve(const mgapModel &model, const solverLimits &limits,
+			solverResult &result);
+	void dumpSolution(void);
+};
+
+bool RMPointsSolver::solve(const mgapModel &instance, const solverLimits &limits,
+			solverResult &result)
+{
+	struct timeval st, e;
+	double ticks;
+	int threads;
+	bool ret = true;
+
+	mgap = instance;
+	solution.clear();
+	result.good = false;
+	result.etimes = 0;
+	result.energy = 0.0;
+	result.gap = 0.0;
+	result.ticks = 0.0;
+
+	try {
+		IloInt i, j, k, p;
+		unsigned int h;
+		const NumArray2 &cycles = mgap.cycles;
+		const NumArray2 &frequency = mgap.frequency;
+		const NumArray &period = mgap.period;
+		int nAgents = cycles.size();
+		int nTasks = period.size();
+		int nLevels = frequency[0].size();
+		vector <int> order(nTasks);
+		vector <vector <int> > hp(nTasks);
+		vector <NumArray> points(nTasks);
+
+		mgapCoefficients coef;
+
+		coef.compute(mgap);
+
+		/* hp-sets by decreasing priority, equal priorities do not interfere */
+		for (j = 0; j < nTasks; j++)
+			order[j] = j;
+		sort(order.begin(), order.end(), higherPriority(mgap.priority));
+		for (j = 0; j < nTasks; j++) {
+			for (p = 0; p < nTasks; p++)
+				if (mgap.priority[order[p]] > mgap.priority[j])
+					hp[j].push_back(order[p]);
+			testingPoints(mgap, j, hp[j], points[j]);
+		}
+
+		IloArray<IloArray<IloNumVarArray> > x(env, nAgents);
+		IloArray<IloArray<IloNumVarArray> > z(env, nAgents);
+		for (i = 0; i < nAgents; i++) {
+			x[i] = IloArray<IloNumVarArray>(env, nTasks);
+			z[i] = IloArray<IloNumVarArray>(env, nTasks);
+			for (j = 0; j < nTasks; j++) {
+				if (!limits.relaxIntegrity) {
+				/* Here we want integer */
+					x[i][j] = IloNumVarArray(env, nLevels, 0, 1, ILOINT);
+					z[i][j] = IloNumVarArray(env, points[j].size(), 0, 1, ILOINT);
+				} else {
+				/* Here we want real */
+					x[i][j] = IloNumVarArray(env, nLevels, 0, 1);
+					z[i][j] = IloNumVarArray(env, points[j].size(), 0, 1);
+				}
+			}
+		}
+
+		IloModel model(env);
+		IloConstraintArray constraints(env);
+
+		IloExpr obj(env);
+		for(i = 0; i < nAgents; i++)
+			for(j = 0; j < nTasks; j++)
+				for(k = 0; k < nLevels; k++)
+					obj += coef.energy[coef.index(i, j, k)] * x[i][j][k];
+		IloObjective objective = IloMinimize(env, obj);
+		model.add(objective);
+		obj.end();
+
+		for(j = 0; j < nTasks; j++) {
+			IloExpr v(env);
+			for(i = 0; i < nAgents; i++)
+				for(k = 0; k < nLevels; k++)
+					v += x[i][j][k];
+			constraints.add(v == 1); /* Each task receive only one freq */
+			v.end();
+		}
+
+		/* implied by the points, but it tightens the relaxation */
+		for(i = 0; i < nAgents; i++) {
+			IloExpr v(env);
+			for(j = 0; j < nTasks; j++) {
+				for(k = 0; k < nLevels; k++)
+					v += coef.U[coef.index(i, j, k)] * x[i][j][k];
+			}
+			constraints.add(v <= 1.0); /* Each agent has a budget */
+			v.end();
+		}
+
+		for (i = 0; i < nAgents; i++) {
+			for (j = 0; j < nTasks; j++) {
+				IloExpr chosen(env);
+
+				/* a task on the agent picks a point that holds */
+				for (p = 0; p < (IloInt)points[j].size(); p++)
+					chosen += z[i][j][p];
+				for (k = 0; k < nLevels; k++)
+					chosen -= x[i][j][k];
+				constraints.add(chosen == 0);
+				chosen.end();
+
+				for (p = 0; p < (IloInt)points[j].size(); p++) {
+					double t = points[j][p];
+					double M = -t, c;
+					IloExpr demand(env);
+
+					/* M: the most the demand can exceed t by */
+					for (c = 0.0, k = 0; k < nLevels; k++) {
+						demand += coef.C[coef.index(i, j, k)] * x[i][j][k];
+						c = max(c, coef.C[coef.index(i, j, k)]);
+					}
+					M += c;
+					for (h = 0; h < hp[j].size(); h++) {
+						double jobs = jobsBefore(t, period[hp[j][h]]);
+
+						for (c = 0.0, k = 0; k < nLevels; k++) {
+							demand += jobs * coef.C[coef.index(i, hp[j][h], k)] *
+								x[i][hp[j][h]][k];
+							c = max(c, coef.C[coef.index(i, hp[j][h], k)]);
+						}
+						M += jobs * c;
+					}
+					if (M < 0.0)
+						M = 0.0;
+					constraints.add(demand + M * z[i][j][p] <= t + M);
+					demand.end();
+				}
+			}
+		}
+		model.add(constraints);
+
+		/* created once, the licence is checked out only for the first model */
+		if (!cplex.getImpl()) {
+			cplex = IloCplex(env);
+			cplex.setOut(env.getNullStream());
+			cplex.setParam(IloCplex::Param::ClockType, 2); /* Wallclock */
+			cplex.setParam(IloCplex::WorkMem, 1024);
+			cplex.setParam(IloCplex::TreLim, 2048);
+		}
+		/* parameters left by the previous model go back to the defaults */
+		cplex.setParam(IloCplex::TiLim, limits.seconds > 0.0 ?
+					limits.seconds : 1e+75);
+		cplex.setParam(IloCplex::CutUp, limits.upperCut > 0.0 ?
+					limits.upperCut * 1.05 : 1e+75);
+		threads = setParallel(cplex, limits);
+
+		cplex.extract(model);
+
+		/* a starting point, given or from the heuristic, timed with the solve */
+		gettimeofday(&st, NULL);
+		warmStart(cplex, x, mgap, limits, RM_RESPONSE, true);
+
+		/* no candidates to check, the model holds the whole test */
+		SolverCallback callback(x, threads);
+
+		if (limits.rounding && !limits.relaxIntegrity)
+			callback.roundRelaxations(mgap, RM_RESPONSE);
+		if (callback.contexts())
+			cplex.use(&callback, callback.contexts());
+		ticks = cplex.getDetTime();
+		cplex.solve();
+		gettimeofday(&e, NULL);
+		result.ticks = cplex.getDetTime() - ticks;
+
+		result.etimes = get_execution_time(st, e);
+
+		if (cplex.getStatus() == IloAlgorithm::Feasible ||
+				cplex.getStatus() == IloAlgorithm::Optimal) {
+			objValue = cplex.getObjValue();
+			result.good = objValue >= 0;
+			if (result.good) {
+				result.energy = objValue;
+				result.gap = cplex.getMIPRelativeGap() * 100.0;
+			}
+
+			solution.resize(nAgents);
+			for (i = 0; i < nAgents; i++) {
+				solution[i].resize(nTasks);
+				for (j = 0; j < nTasks; j++) {
+					solution[i][j].resize(nLevels);
+					for (k = 0; k < nLevels; k++)
+						solution[i][j][k] = cplex.getValue(x[i][j][k]);
+				}
+			}
+		}
+
+		cplex.use(&callback, 0);
+		cplex.clearModel();
+		endConcert(constraints);
+		objective.end();
+		model.end();
+		endConcert(x);
+		endConcert(z);
+	}
+	catch(IloException& e) {
+		cerr  << " ERROR: " << e << endl;
+		ret = false;
+	}
+	catch(...) {
+		cerr  << " ERROR" << endl;
+		ret = false;
+	}
+	/* whatever the failed model left behind goes with its environment */
+	if (!ret) {
+		env.end();
+		env = IloEnv();
+		cplex = IloCplex();
+	}
+	return ret;
+}
+
+void RMPointsSolver::dumpSolution(void)
+{
+	int i, j, k;
+
+	if (solution.empty())
+		return;
+
+	cout << "Optimal System Energy: " << objValue << endl;
+	for(i = 0; i < (int)solution.size(); i++) {
+		for(j = 0; j < (int)solution[i].size(); j++) {
+			for(k = 0; k < (int)solution[i][j].size(); k++) {
+				if (solution[i][j][k]) {
+					cout << solution[i][j][k] << " Task[" << j
+						<< "] runs in processor " << i
+						<< " at level [" << k << "] ("
+						<< mgap.frequency[i][k] << "Hz@"
+						<< mgap.voltage[i][k] << "V)" << endl;
+				}
+			}
+		}
+	}
+	dumpConfigurationInfo(mgap, solution);
+}
+
+static Solver *createRMPointsSolver(void)
+{
+	return new RMPointsSolver();
+}
+
+static SolverRegistration registration("rm_points", createRMPointsSolver);
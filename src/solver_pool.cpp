@@ -0,0 +1,196 @@
+/*
+ * src/solver_pool.cpp
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <solver_pool.h>
+
+/*
+ * allowedCPUs: the CPUs of the process affinity mask, empty unless the
+ * mask is narrower than the machine. A process that was given its own set
+ * (taskset, a cpuset, the batch system) shares it among its workers; one
+ * that may run anywhere leaves placement to the kernel, as several of
+ * them on a node cannot know the CPUs the others took.
+ * @complexity: O(CPU_SETSIZE)
+ */
+static void allowedCPUs(vector <int> &cpus)
+{
+	long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+	cpu_set_t allowed;
+	int c;
+
+	cpus.clear();
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) < 0 ||
+	    CPU_COUNT(&allowed) >= ncpus)
+		return;
+
+	for (c = 0; c < CPU_SETSIZE; c++)
+		if (CPU_ISSET(c, &allowed))
+			cpus.push_back(c);
+}
+
+SolverPool::SolverPool(const vector <string> &solvers, const char *tmpTemplate)
+	:workers(solvers.size()), tmpTemplate(tmpTemplate),
+	sample(0), pending(0), quit(false), model(NULL),
+	limits(NULL)
+{
+	vector <int> cpus;
+	unsigned int i;
+
+	allowedCPUs(cpus);
+
+	pthread_mutex_init(&lock, NULL);
+	pthread_cond_init(&start, NULL);
+	pthread_cond_init(&done, NULL);
+
+	for (i = 0; i < workers.size(); i++) {
+		istringstream line(solvers[i]);
+		string name;
+
+		line >> name;
+		workers[i].pool = this;
+		workers[i].command = solvers[i];
+		workers[i].solver = createSolver(name);
+		workers[i].ok = false;
+
+		pthread_create(&workers[i].thread, NULL, run, &workers[i]);
+		if (!cpus.empty()) {
+			int cpu = cpus[i % cpus.size()];
+			cpu_set_t set;
+
+			CPU_ZERO(&set);
+			CPU_SET(cpu, &set);
+			if (pthread_setaffinity_np(workers[i].thread,
+						sizeof(set), &set))
+				cerr << "WARNING: could not pin solver '"
+					<< solvers[i] << "' to CPU " << cpu
+					<< ", it runs unpinned" << endl;
+		}
+	}
+}
+
+SolverPool::~SolverPool()
+{
+	unsigned int i;
+
+	pthread_mutex_lock(&lock);
+	quit = true;
+	pthread_cond_broadcast(&start);
+	pthread_mutex_unlock(&lock);
+
+	for (i = 0; i < workers.size(); i++) {
+		pthread_join(workers[i].thread, NULL);
+		delete workers[i].solver;
+	}
+
+	pthread_cond_destroy(&done);
+	pthread_cond_destroy(&start);
+	pthread_mutex_destroy(&lock);
+}
+
+/*
+ * solve: runs all solvers over model concurrently
+ * @complexity: the slowest solver
+ */
+void SolverPool::solve(const mgapModel &model, const solverLimits &limits)
+{
+	pthread_mutex_lock(&lock);
+	this->model = &model;
+	this->limits = &limits;
+	pending = workers.size();
+	sample++;
+	pthread_cond_broadcast(&start);
+	while (pending > 0)
+		pthread_cond_wait(&done, &lock);
+	this->model = NULL;
+	this->limits = NULL;
+	pthread_mutex_unlock(&lock);
+}
+
+void *SolverPool::run(void *data)
+{
+	struct worker *w = (struct worker *)data;
+	SolverPool *pool = w->pool;
+	unsigned long seen = 0;
+
+	pthread_mutex_lock(&pool->lock);
+	for (;;) {
+		while (pool->sample == seen && !pool->quit)
+			pthread_cond_wait(&pool->start, &pool->lock);
+		if (pool->quit)
+			break;
+		seen = pool->sample;
+		pthread_mutex_unlock(&pool->lock);
+
+		if (w->solver)
+			w->ok = w->solver->solve(*pool->model, *pool->limits,
+							w->result);
+		else
+			w->ok = pool->executeCommand(w->command, w->result);
+
+		pthread_mutex_lock(&pool->lock);
+		if (--pool->pending == 0)
+			pthread_cond_signal(&pool->done);
+	}
+	pthread_mutex_unlock(&pool->lock);
+
+	return NULL;
+}
+
+/*
+ * execute_command: fallback for solvers not built in, writes the model to
+ * a temporary file and runs command over it
+ */
+bool SolverPool::executeCommand(const string &command, solverResult &result)
+{
+	vector <char> filename(tmpTemplate.begin(), tmpTemplate.end());
+	string cmd, output;
+	ofstream mfile;
+	FILE *pipe;
+	char buffer[128];
+	int fd, good = 0, n;
+
+	filename.push_back('\0');
+	fd = mkstemp(&filename[0]);
+	if (fd < 0)
+		return false;
+	close(fd);
+
+	mfile.open(&filename[0]);
+	writeModel(mfile, *model);
+	mfile.close();
+
+	cmd = command + " " + &filename[0];
+	pipe = popen(cmd.c_str(), "r");
+	if (!pipe) {
+		unlink(&filename[0]);
+		return false;
+	}
+
+	while (fgets(buffer, sizeof(buffer), pipe) != NULL)
+		output += buffer;
+	pclose(pipe);
+	unlink(&filename[0]);
+
+	n = sscanf(output.c_str(), "%d %ld %lf", &good, &result.etimes,
+					&result.energy);
+	result.good = good;
+	result.gap = 0.0;
+	result.ticks = 0.0;
+
+	return n == 3;
+}
@@ -0,0 +1,274 @@
+/*
+ * src/statistics.cpp
+ *
+ * Copyright (C) 2014 Eduardo Valentin <edubezval@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fstream>
+#include <iomanip>
+#include <string>
+
+#include <statistics.h>
+
+/* Random streams */
+
+/*
+ * normal: Marsaglia polar method
+ * @complexity: O(1) expected
+ */
+double RandomStream::normal(double mean, double sd)
+{
+	double u, v, s;
+
+	if (haveSpare) {
+		haveSpare = false;
+		return mean + sd * spare;
+	}
+
+	do {
+		u = 2.0 * real() - 1.0;
+		v = 2.0 * real() - 1.0;
+		s = u * u + v * v;
+	} while (s >= 1.0 || s == 0.0);
+
+	s = sqrt(-2.0 * log(s) / s);
+	spare = v * s;
+	haveSpare = true;
+
+	return mean + sd * u * s;
+}
+
+/* Parameters */
+bool statisticsParams::read(const char *filename)
+{
+	ifstream file(filename);
+	string line;
+
+	if (!file)
+		return false;
+
+	while (getline(file, line)) {
+		char key[64];
+		char value[64];
+
+		if (sscanf(line.c_str(), " %63[A-Za-z] = %63s", key, value) != 2)
+			continue;
+
+		if (!strcmp(key, "RelError"))
+			relError = strtod(value, NULL);
+		else if (!strcmp(key, "Confidence"))
+			confidence = strtod(value, NULL);
+		else if (!strcmp(key, "MinObs"))
+			minObs = strtoul(value, NULL, 10);
+		else if (!strcmp(key, "MaxObs"))
+			maxObs = strtoul(value, NULL, 10);
+		else if (!strcmp(key, "Seed"))
+			seed = strtoull(value, NULL, 10);
+		else if (!strcmp(key, "AnalysisMethod") &&
+			 !strcmp(value, "BatchMeans"))
+			continue;
+		else if (!strcmp(key, "MaxTransientObs") ||
+			 !strcmp(key, "MaxSchrubenHeuristicObs"))
+			cerr << "WARNING: " << filename << ": " << key
+				<< " ignored, there is no transient detection,"
+				<< " MinObs stands for it" << endl;
+		else
+			cerr << "WARNING: " << filename << ": " << key
+				<< " = " << value << " is not supported, ignored"
+				<< endl;
+	}
+
+	return true;
+}
+
+/* Quantiles */
+
+/*
+ * normal_quantile: inverse of the standard normal distribution, P. J.
+ * Acklam's rational approximation, relative error below 1.15e-9
+ */
+static double normal_quantile(double p)
+{
+	static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02,
+		-2.759285104469687e+02, 1.383577518672690e+02,
+		-3.066479806614716e+01, 2.506628277459239e+00 };
+	static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02,
+		-1.556989798598866e+02, 6.680131188771972e+01,
+		-1.328068155288572e+01 };
+	static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01,
+		-2.400758277161838e+00, -2.549732539343734e+00,
+		4.374664141464968e+00, 2.938163982698783e+00 };
+	static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01,
+		2.445134137142996e+00, 3.754408661907416e+00 };
+	double q, r;
+
+	if (p < 0.02425) {
+		q = sqrt(-2.0 * log(p));
+		return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+			((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+	}
+	if (p > 1.0 - 0.02425)
+		return -normal_quantile(1.0 - p);
+
+	q = p - 0.5;
+	r = q * q;
+	return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+		(((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+/*
+ * studentQuantile: Cornish-Fisher expansion of the t quantile around the
+ * normal one, good to three digits from 3 degrees of freedom on
+ */
+double studentQuantile(double confidence, int dof)
+{
+	double z = normal_quantile(0.5 + confidence / 2.0);
+	double z2 = z * z, n = dof;
+
+	if (dof <= 0)
+		return HUGE_VAL;
+
+	return z + z * (z2 + 1.0) / (4.0 * n) +
+		z * ((5.0 * z2 + 16.0) * z2 + 3.0) / (96.0 * n * n) +
+		z * (((3.0 * z2 + 19.0) * z2 + 17.0) * z2 - 15.0) /
+			(384.0 * n * n * n);
+}
+
+/* Estimator */
+SequentialEstimator::SequentialEstimator(int nparams,
+					const statisticsParams &params)
+	:params(params)
+{
+	reset(nparams);
+}
+
+void SequentialEstimator::reset(int nparams)
+{
+	int i;
+
+	parameters.resize(nparams);
+	for (i = 0; i < nparams; i++) {
+		parameters[i].count = 0;
+		parameters[i].batchSize = 1;
+		parameters[i].inBatch = 0;
+		parameters[i].batchSum = 0.0;
+		parameters[i].batches.clear();
+		parameters[i].batches.reserve(MAX_BATCHES);
+		parameters[i].converged = false;
+		parameters[i].stopping = true;
+	}
+}
+
+/*
+ * observe: adds value to the open batch of param, and tests param for
+ * convergence when the batch closes at a checkpoint
+ * @complexity: O(1) amortized, O(MAX_BATCHES) at checkpoints
+ */
+void SequentialEstimator::observe(int param, double value)
+{
+	struct parameter &p = parameters[param];
+	unsigned int i;
+
+	p.count++;
+	p.batchSum += value;
+	if (++p.inBatch < p.batchSize)
+		return;
+
+	p.batches.push_back(p.batchSum / p.batchSize);
+	p.inBatch = 0;
+	p.batchSum = 0.0;
+
+	if (p.count >= params.minObs && p.batches.size() % MIN_BATCHES == 0)
+		p.converged = converged(param);
+
+	if (p.batches.size() < MAX_BATCHES)
+		return;
+
+	/* halve the number of batches, doubling their size */
+	for (i = 0; i < MAX_BATCHES / 2; i++)
+		p.batches[i] = (p.batches[2 * i] + p.batches[2 * i + 1]) / 2.0;
+	p.batches.resize(MAX_BATCHES / 2);
+	p.batchSize *= 2;
+}
+
+bool SequentialEstimator::estimate(int param, double &mean, double &delta,
+				double &variance, unsigned long &count)
+{
+	struct parameter &p = parameters[param];
+	int i, n = p.batches.size();
+	double sum = 0.0, ss = 0.0;
+
+	count = p.count;
+	mean = delta = variance = 0.0;
+	if (n < 2)
+		return false;
+
+	for (i = 0; i < n; i++)
+		sum += p.batches[i];
+	mean = sum / n;
+	for (i = 0; i < n; i++)
+		ss += (p.batches[i] - mean) * (p.batches[i] - mean);
+	/* variance of the batch means, hence of the mean times n */
+	variance = ss / (n - 1);
+	delta = studentQuantile(params.confidence, n - 1) * sqrt(variance / n);
+
+	return n >= MIN_BATCHES;
+}
+
+bool SequentialEstimator::converged(int param)
+{
+	double mean, delta, variance;
+	unsigned long count;
+
+	if (!estimate(param, mean, delta, variance, count))
+		return false;
+
+	return delta <= params.relError * fabs(mean);
+}
+
+/*
+ * over: true when every stopping parameter converged at its last
+ * checkpoint or MaxObs observations were made of any parameter
+ * @complexity: O(nparams)
+ */
+bool SequentialEstimator::over(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < parameters.size(); i++)
+		if (params.maxObs && parameters[i].count >= params.maxObs)
+			return true;
+
+	for (i = 0; i < parameters.size(); i++)
+		if (parameters[i].stopping && !parameters[i].converged)
+			return false;
+
+	return true;
+}
+
+void SequentialEstimator::report(ostream &os)
+{
+	double mean, delta, variance;
+	unsigned long count;
+	unsigned int i;
+
+	os << "Param     Estimate        Delta  Conf          Var    Count" << endl;
+	for (i = 0; i < parameters.size(); i++) {
+		estimate(i, mean, delta, variance, count);
+		os << setw(5) << i + 1 << " "
+			<< setw(12) << setprecision(6) << mean << " "
+			<< setw(12) << delta << " "
+			<< setw(5) << setprecision(2) << params.confidence << " "
+			<< setw(12) << setprecision(6) << variance << " "
+			<< setw(8) << count << endl;
+	}
+}